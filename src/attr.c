@@ -0,0 +1,161 @@
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <string.h> // memcpy, memset
+
+#include "attr.h"
+#include "fade.h" // palette_upload_reserve
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define ROW_CLEAN 0xFF // attr_dirty_left of a row with nothing to flush
+
+uint8_t attr_shadow[ATTR_MAP_WIDTH * ATTR_MAP_HEIGHT];
+
+uint8_t attr_dirty_left[ATTR_MAP_HEIGHT]; // per row, inclusive span
+uint8_t attr_dirty_right[ATTR_MAP_HEIGHT];
+uint8_t attr_dirty_top = ROW_CLEAN; // rows the handler scans, ROW_CLEAN if none
+uint8_t attr_dirty_bottom;
+
+uint16_t attr_spilled_rows;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  HANDLERS  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void flush_row(uint8_t y) {
+
+	uint8_t left = attr_dirty_left[y];
+	uint16_t offset = (uint16_t)y * ATTR_MAP_WIDTH + left;
+
+	memcpy(_SCRN0 + offset, attr_shadow + offset, attr_dirty_right[y] - left + 1);
+	attr_dirty_left[y] = ROW_CLEAN;
+
+}
+
+static void flush_rows(uint8_t is_budgeted) {
+
+	uint8_t vbk = VBK_REG & 0x01; // NOTE: may interrupt code with the attribute bank selected
+	VBK_REG = VBK_ATTRIBUTES;
+
+	uint8_t y = attr_dirty_top;
+	for (; y <= attr_dirty_bottom; y++) {
+		if (attr_dirty_left[y] == ROW_CLEAN) continue;
+		if (is_budgeted && (LY_REG < 144 || LY_REG >= ATTR_FLUSH_LAST_LINE)) break;
+
+		flush_row(y);
+	}
+
+	VBK_REG = vbk;
+
+	if (y > attr_dirty_bottom) {
+		attr_dirty_top = ROW_CLEAN;
+		palette_upload_reserve = 0;
+	} else {
+		attr_dirty_top = y; // NOTE: out of VBlank, the rest next frame
+
+		for (; y <= attr_dirty_bottom; y++) {
+			if (attr_dirty_left[y] != ROW_CLEAN) attr_spilled_rows++;
+		}
+	}
+
+}
+
+void attr_vbl_isr(void) {
+
+	if (attr_dirty_top != ROW_CLEAN) flush_rows(TRUE);
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void mark_rows(uint8_t x, uint8_t y, uint8_t w, uint8_t h) { // NOTE: after the shadow is written
+
+	uint8_t right = x + w - 1;
+	uint8_t bottom = y + h - 1;
+
+	CRITICAL {
+		for (uint8_t row = y; row <= bottom; row++) {
+			if (attr_dirty_left[row] == ROW_CLEAN) {
+				attr_dirty_left[row] = x;
+				attr_dirty_right[row] = right;
+				continue;
+			}
+			if (x < attr_dirty_left[row]) attr_dirty_left[row] = x;
+			if (right > attr_dirty_right[row]) attr_dirty_right[row] = right;
+		}
+
+		if (attr_dirty_top == ROW_CLEAN) {
+			attr_dirty_top = y;
+			attr_dirty_bottom = bottom;
+			palette_upload_reserve = ATTR_FLUSH_RESERVED_LINES; // NOTE: palette uploads alone can fill VBlank up to 152
+		} else {
+			if (y < attr_dirty_top) attr_dirty_top = y;
+			if (bottom > attr_dirty_bottom) attr_dirty_bottom = bottom;
+		}
+	}
+
+}
+
+void attr_init(void) {
+
+	memset(attr_shadow, 0x00, sizeof(attr_shadow));
+	memset(attr_dirty_left, ROW_CLEAN, sizeof(attr_dirty_left));
+	attr_dirty_top = ROW_CLEAN;
+	palette_upload_reserve = 0;
+
+	CRITICAL {
+		add_VBL(attr_vbl_isr); // NOTE: after the palette and raster handlers, ATTR_FLUSH_RESERVED_LINES keeps it a share
+	}
+
+}
+
+void attr_set(uint8_t x, uint8_t y, uint8_t attr) {
+
+	attr_shadow[(uint16_t)y * ATTR_MAP_WIDTH + x] = attr;
+	mark_rows(x, y, 1, 1);
+
+}
+
+void attr_set_palette(uint8_t x, uint8_t y, uint8_t palette) { // keeps bank, flip and priority bits
+
+	uint8_t* attr = &attr_shadow[(uint16_t)y * ATTR_MAP_WIDTH + x];
+	*attr = (*attr & ~ATTR_PALETTE_MASK) | (palette & ATTR_PALETTE_MASK);
+	mark_rows(x, y, 1, 1);
+
+}
+
+void attr_fill_palette(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t palette) { // rectangle inside the map, no wrap
+
+	if (w == 0 || h == 0) return; // NOTE: y + h - 1 would wrap, marking rows past the map
+
+	palette &= ATTR_PALETTE_MASK;
+
+	for (uint8_t row = 0; row < h; row++) {
+		uint8_t* attr = &attr_shadow[(uint16_t)(y + row) * ATTR_MAP_WIDTH + x];
+		for (uint8_t col = 0; col < w; col++, attr++) {
+			*attr = (*attr & ~ATTR_PALETTE_MASK) | palette;
+		}
+	}
+
+	mark_rows(x, y, w, h);
+
+}
+
+void attr_flush(void) { // LCD off: every dirty row at once, no budget
+
+	CRITICAL {
+		if (attr_dirty_top != ROW_CLEAN) flush_rows(FALSE);
+	}
+
+}
+
+void attr_set_sprite_palette(uint8_t nb, uint8_t palette) { // keeps the other OAM flags
+
+	set_sprite_prop(nb, (get_sprite_prop(nb) & ~ATTR_PALETTE_MASK) | (palette & ATTR_PALETTE_MASK));
+
+}
@@ -0,0 +1,61 @@
+#ifndef ATTR_H
+#define ATTR_H
+
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Shadow of the bkg attribute map (VBK_ATTRIBUTES at 0x9800) in WRAM, flushed in VBlank.
+
+	Game code edits the shadow, any number of tiles per frame. Each row keeps one dirty span
+	(leftmost to rightmost edited tile), the VBL handler copies the dirty spans as row bursts
+	with a single VBK_REG switch, instead of a switch and a VRAM-access wait per tile.
+	Rows that dont fit before ATTR_FLUSH_LAST_LINE are left dirty for the next VBlank.
+	The handler runs after the palette handler, which stops ATTR_FLUSH_RESERVED_LINES early
+	while rows are dirty (`palette_upload_reserve`), so every VBlank flushes at least a row.
+
+	Usage:
+		- `attr_init()` once, after clearing the attribute map (the shadow starts all zero).
+		- `attr_set()` / `attr_set_palette()` per tile, `attr_fill_palette()` for rectangles.
+		- `attr_flush()` with the LCD off, where no VBlank comes (scene setup).
+		- sprites: `attr_set_sprite_palette()`, the palette bits of the shadow OAM, which GBDK
+		  already copies to OAM in VBlank.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -------------------------------------  ATTR MACROS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define ATTR_MAP_WIDTH 32
+#define ATTR_MAP_HEIGHT 32
+
+#define ATTR_PALETTE_MASK 0x07 // bits 0-2, palette-index, bkg and OAM alike
+
+#define ATTR_FLUSH_LAST_LINE 150 // no row starts past this line, a full row is under 2 lines at single speed
+#define ATTR_FLUSH_RESERVED_LINES 3 // palette uploads end at line 149 while rows are dirty, lines 149-150 start rows
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+extern uint8_t attr_shadow[ATTR_MAP_WIDTH * ATTR_MAP_HEIGHT]; // read-only, edit through attr_set*()
+extern uint16_t attr_spilled_rows; // dirty rows left for the next VBlank, since boot
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void attr_init(void);
+
+void attr_set(uint8_t x, uint8_t y, uint8_t attr);
+void attr_set_palette(uint8_t x, uint8_t y, uint8_t palette);
+void attr_fill_palette(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t palette);
+void attr_flush(void);
+
+void attr_set_sprite_palette(uint8_t nb, uint8_t palette);
+
+#endif
@@ -0,0 +1,1087 @@
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+#include <string.h> // memcpy
+
+#include "fade.h"
+#include "fade_profile.h" // PROFILE_*, empty unless FADE_PROFILE
+#include "speed.h" // speed_push_fast(), speed_pop()
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+//+ -------------------------------  STATE  ------------------------------- +//
+
+#ifdef FADE_BANKED
+BANKREF(fade) // FADE_ROM_BANK
+#endif
+
+bool is_fading = FALSE;
+
+typedef struct { // one running fade, each slot belongs to at most one
+	fade_pace_t pace; // DDA pace, fade_math.c
+	uint8_t frames_left;
+	uint8_t frames_total; // reused by fade_reverse_id()
+	uint16_t slots_mask; // palettes in this fade
+	uint16_t active_mask; // palettes still fading, converged palettes are dropped
+	uint16_t rest_mask; // slots back at rest once this fade ends
+	bool is_fast; // holds a speed_push_fast()
+} fade_t;
+
+fade_t fades[FADE_MAX_RUNNING];
+uint8_t fade_running_mask; // bit per fade id
+uint16_t fade_skipped_uploads;
+uint16_t palette_spilled_uploads;
+volatile uint8_t palette_upload_reserve; // VBlank lines before PALETTE_UPLOAD_LAST_LINE left to the VBL handlers after this one
+
+//+ -----------------------------  PALETTES  ------------------------------ +//
+
+const palette_color_t* current_palettes_LUT[PALETTE_SLOTS];
+const palette_color_t* fade_target_LUT[PALETTE_SLOTS]; // pointers, slot-index to the palette the running fade moves towards
+const palette_color_t* fade_origin_LUT[PALETTE_SLOTS]; // pointers, slot-index to the palette the running fade started on, NULL: unknown colors
+
+palette_color_t palette_shadow[PALETTE_SLOTS * PALETTE_SIZE]; // 128 bytes, back-buffer: WRAM mirror of all of palette RAM, bkg then sprites
+palette_color_t palette_front[PALETTE_SLOTS * PALETTE_SIZE]; // front-buffer: staged palettes, only read by the VBL handlers
+
+#ifdef FADE_BANKED
+palette_color_t palette_home[PALETTE_SLOTS * PALETTE_SIZE]; // WRAM copies of palettes tracked from other ROM banks, what the engine reads for them
+uint8_t palette_bank_LUT[PALETTE_SLOTS]; // slot-index to the ROM bank of current_palettes_LUT, 0: read in place (bank 0, FADE_ROM_BANK, WRAM)
+
+#define palette_bank(slot) (palette_bank_LUT[slot])
+#else
+#define palette_bank(slot) 0 // one address space
+#endif
+
+#define palette_bkg_front (&palette_front[PALETTE_SLOT_BKG(0) * PALETTE_SIZE]) // one contiguous 64 byte buffer per layer, for burst uploads
+#define palette_sprite_front (&palette_front[PALETTE_SLOT_SPRITE(0) * PALETTE_SIZE])
+
+const fade_ladder_t* fade_ladders; // baked ladders, see fade_use_ladders()
+uint8_t fade_ladders_count;
+
+fade_ladder_t fade_cache[FADE_CACHE_LADDERS]; // WRAM ladders, see fade_cache_ladder()
+palette_color_t fade_cache_levels[FADE_CACHE_LADDERS][(FADE_DISTANCE + 1) * PALETTE_SIZE];
+uint8_t fade_cache_built[FADE_CACHE_LADDERS]; // levels computed so far
+uint8_t fade_cache_used_mask; // bit per cache entry
+uint8_t fade_cache_ready_mask; // bit per cache entry with every level built
+
+const palette_color_t* fade_ladder_LUT[PALETTE_SLOTS]; // pointers, slot-index to the ladder levels of the running fade, NULL: kernel
+uint8_t fade_ladder_level[PALETTE_SLOTS];
+uint8_t fade_ladder_end[PALETTE_SLOTS];
+
+palette_color_t fade_transform_buffer[PALETTE_SLOTS * PALETTE_SIZE]; // targets built by fade_transform()
+const palette_color_t* fade_transform_LUT[PALETTE_SLOTS]; // pointers into fade_transform_buffer, NULL: not transformed
+
+uint8_t fade_alias_LUT[PALETTE_SLOTS]; // slot-index to an earlier slot of the same fade with the same colors, PALETTE_SLOT_NONE: own fade
+
+uint16_t palette_tracked_mask;
+uint8_t palette_refcount[PALETTE_SLOTS]; // users per slot, from acquire_*_palette()
+uint16_t palette_rest_mask; // shadow holds exactly its const palette from the LUT, fades from the screen may use its ladders
+uint16_t palette_pending_mask; // edited in back-buffer, waiting to be staged
+volatile uint16_t palette_dirty_mask; // staged in front-buffer, waiting for VBlank - only cleared by the VBL handler
+volatile uint16_t palette_restore_mask; // uploaded again from the front-buffer in the next VBlank, changed mid-frame by src/raster.c - only cleared by the VBL handler
+
+//+ -----------------------------  ANIMATION  ----------------------------- +//
+
+typedef struct { // one palette animation track, ticked by the VBL handler
+	uint8_t slot;
+	uint8_t type; // PALETTE_ANIM_*
+	uint8_t period; // frames per tick
+	uint8_t counter; // frames until the next tick
+	uint8_t first; // rotate: first color and number of colors
+	uint8_t count;
+	uint8_t phase; // pingpong: ticks left in this direction, flash: frames left
+	bool is_backward;
+	palette_color_t saved[PALETTE_SIZE]; // flash: colors restored at the end
+} palette_anim_t;
+
+palette_anim_t palette_anims[PALETTE_ANIM_TRACKS];
+volatile uint8_t palette_anim_mask; // bit per running track
+uint16_t palette_anim_slots_mask; // slots owned by a track, fades and edits stop them first
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  PALLETES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+const palette_color_t palette_all_black[] = {
+	RGB(0, 0, 0),
+	RGB(0, 0, 0),
+	RGB(0, 0, 0),
+	RGB(0, 0, 0)
+};
+
+const palette_color_t palette_all_white[] = {
+	RGB(31, 31, 31),
+	RGB(31, 31, 31),
+	RGB(31, 31, 31),
+	RGB(31, 31, 31)
+};
+
+const palette_color_t* const palette_set_black[PALETTE_SLOTS] = PALETTE_SET_OF(palette_all_black); // every slot black, for fade_palettes()
+const palette_color_t* const palette_set_white[PALETTE_SLOTS] = PALETTE_SET_OF(palette_all_white);
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ----------------------------------------  VBLANK  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static uint8_t upload_budget(void) FADE_HOME_FN { // palettes that still fit before PALETTE_UPLOAD_LAST_LINE, 0 once VBlank is closing
+
+	uint8_t ly = LY_REG;
+
+	uint8_t last_line = PALETTE_UPLOAD_LAST_LINE - palette_upload_reserve;
+
+	if (ly < PALETTE_UPLOAD_FIRST_LINE || ly >= last_line) return 0; // NOTE: drawing, or line 153 that already reads as 0
+
+	uint8_t budget = (last_line - ly) * PALETTE_UPLOADS_PER_LINE;
+	if (KEY1_REG & 0x80) budget <<= 1; // NOTE: double speed, twice the writes per line
+
+	return budget;
+
+}
+
+static uint8_t flush_palette_runs(uint8_t mask, bool is_sprite) FADE_HOME_FN { // one auto-increment burst per run of dirty palettes, returns the ones left for next VBlank
+
+	uint8_t first = 0;
+	uint8_t bit = 0x01;
+
+	while (mask) {
+		while (!(mask & bit)) { bit <<= 1; first++; }
+
+		uint8_t budget = upload_budget();
+		if (budget == 0) return mask; // NOTE: VBlank closing, the rest waits in the front-buffer
+
+		uint8_t count = 0;
+		while ((mask & bit) && count < budget) { mask &= ~bit; bit <<= 1; count++; }
+
+		if (is_sprite) set_sprite_palette(first, count, PALETTE_SLOT(palette_sprite_front, first));
+		else set_bkg_palette(first, count, PALETTE_SLOT(palette_bkg_front, first));
+
+		first += count;
+	}
+
+	return 0;
+
+}
+
+static void rotate_colors(palette_color_t* colors, uint8_t count, bool is_backward) FADE_HOME_FN { // by one color, in place
+
+	uint8_t last = count - 1;
+
+	if (is_backward) {
+		palette_color_t first = colors[0];
+		for (uint8_t i = 0; i < last; i++) colors[i] = colors[i + 1];
+		colors[last] = first;
+	} else {
+		palette_color_t end = colors[last];
+		for (uint8_t i = last; i > 0; i--) colors[i] = colors[i - 1];
+		colors[0] = end;
+	}
+
+}
+
+static void palette_anim_tick(void) FADE_HOME_FN { // every running track, changed slots join this VBlank's upload
+
+	uint8_t running = palette_anim_mask;
+	uint16_t changed_mask = 0;
+
+	palette_anim_t* anim = palette_anims;
+
+	for (uint8_t bit = 0x01; running; bit <<= 1, running >>= 1, anim++) {
+		if (!(running & 0x01)) continue;
+		if (--anim->counter != 0) continue;
+
+		anim->counter = anim->period;
+
+		palette_color_t* colors = PALETTE_SLOT(palette_shadow, anim->slot);
+
+		if (anim->type == PALETTE_ANIM_FLASH) {
+			if (palette_dirty_mask & PALETTE_MASK_SLOT(anim->slot)) continue; // NOTE: flash color not on screen yet, frames count from its upload
+			if (--anim->phase != 0) continue;
+
+			memcpy(colors, anim->saved, PALETTE_BYTES);
+			palette_anim_mask &= ~bit;
+			palette_anim_slots_mask &= ~PALETTE_MASK_SLOT(anim->slot);
+		} else {
+			rotate_colors(&colors[anim->first], anim->count, anim->is_backward);
+
+			if (anim->type == PALETTE_ANIM_PINGPONG && --anim->phase == 0) {
+				anim->phase = anim->count - 1;
+				anim->is_backward = !anim->is_backward;
+			}
+		}
+
+		changed_mask |= PALETTE_MASK_SLOT(anim->slot);
+	}
+
+	if (changed_mask == 0) return;
+
+	uint16_t mask = changed_mask;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1) {
+		if ((uint8_t)mask & 0x01) memcpy(PALETTE_SLOT(palette_front, slot), PALETTE_SLOT(palette_shadow, slot), PALETTE_BYTES);
+	}
+
+	palette_dirty_mask |= changed_mask;
+
+}
+
+void palette_vbl_isr(void) FADE_HOME_FN { // the only place palette RAM is written during gameplay, always in VBlank
+
+	if (palette_anim_mask != 0) palette_anim_tick(); // NOTE: first, so its changes go out in this upload
+
+	uint16_t dirty_mask = palette_dirty_mask;
+	uint16_t upload_mask = dirty_mask | palette_restore_mask; // NOTE: restores dont hold up stage_palettes(), the same budget covers both
+
+	if (upload_mask == 0) return;
+
+	PROFILE_BEGIN(PROFILE_UPLOAD);
+
+	// NOTE: spilled palettes stay dirty, stage_palettes() waits for them, so the next VBlank resumes exactly where this one stopped
+
+	uint8_t bkg_left = flush_palette_runs((uint8_t)upload_mask, FALSE);
+	uint8_t sprite_left = flush_palette_runs((uint8_t)(upload_mask >> 8), TRUE);
+
+	uint16_t left_mask = ((uint16_t)sprite_left << 8) | bkg_left;
+
+	palette_dirty_mask = left_mask & dirty_mask;
+	palette_restore_mask = left_mask & ~dirty_mask;
+
+	if (left_mask != 0) palette_spilled_uploads++;
+
+	PROFILE_END(PROFILE_UPLOAD);
+
+}
+
+void fade_init(void) FADE_BANKED_FN {
+
+	CRITICAL {
+		add_VBL(palette_vbl_isr);
+	}
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -------------------------------------  RUNNING FADES  ------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void release_slots(fade_t* fade, uint16_t slots_mask) { // drop slots from a fade, its aliases of them fade on their own
+
+	fade->slots_mask &= ~slots_mask;
+	fade->active_mask &= ~slots_mask;
+	fade->rest_mask &= ~slots_mask;
+
+	uint16_t mask = fade->slots_mask;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1) {
+		if (!((uint8_t)mask & 0x01)) continue;
+		if (fade_alias_LUT[slot] == PALETTE_SLOT_NONE) continue;
+		if (!(slots_mask & PALETTE_MASK_SLOT(fade_alias_LUT[slot]))) continue;
+
+		fade_alias_LUT[slot] = PALETTE_SLOT_NONE;
+		fade_ladder_LUT[slot] = NULL; // NOTE: its ladder level never moved, the kernel goes on from its colors
+	}
+
+}
+
+static void end_fade(uint8_t id) {
+
+	palette_rest_mask |= fades[id].rest_mask;
+
+	if (fades[id].is_fast) {
+		fades[id].is_fast = FALSE;
+		speed_pop();
+	}
+
+	fade_running_mask &= ~(uint8_t)(1 << id);
+	is_fading = (fade_running_mask != 0);
+
+}
+
+static void stop_fades(uint16_t slots_mask) { // running fades let go of these slots, a fade left empty ends
+
+	for (uint8_t id = 0; id < FADE_MAX_RUNNING; id++) {
+		if (!(fade_running_mask & (uint8_t)(1 << id))) continue;
+
+		release_slots(&fades[id], slots_mask);
+		if (fades[id].slots_mask == 0) end_fade(id);
+	}
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  TRACKING  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void clear_palettes_LUT(void) FADE_BANKED_FN {
+
+	for (uint8_t i = 0; i < PALETTE_SLOTS; i++) {
+		current_palettes_LUT[i] = NULL;
+		palette_refcount[i] = 0;
+#ifdef FADE_BANKED
+		palette_bank_LUT[i] = 0;
+#endif
+	}
+
+	palette_tracked_mask = 0;
+
+	CRITICAL {
+		palette_anim_mask = 0;
+		palette_anim_slots_mask = 0;
+	}
+
+	fade_cache_clear(); // NOTE: ladders are per scene
+
+}
+
+static const palette_color_t* palette_colors(uint8_t slot, const palette_color_t* palette) { // where the engine reads palette: the WRAM copy for the slot's own palette from another bank, else palette
+
+#ifdef FADE_BANKED
+	if (palette_bank_LUT[slot] != 0 && palette == current_palettes_LUT[slot]) return PALETTE_SLOT(palette_home, slot);
+#else
+	(void)slot;
+#endif
+
+	return palette;
+
+}
+
+static void track_colors(uint8_t slot, const palette_color_t* palette, const palette_color_t* colors) { // palette into the LUT, its colors (palette itself, or a WRAM copy) into the back-buffer
+
+	palette_anim_stop(PALETTE_MASK_SLOT(slot));
+
+	current_palettes_LUT[slot] = palette;
+
+	PROFILE_BEGIN(PROFILE_COPY);
+	memcpy(PALETTE_SLOT(palette_shadow, slot), colors, PALETTE_BYTES);
+	PROFILE_END(PROFILE_COPY);
+
+	palette_tracked_mask |= PALETTE_MASK_SLOT(slot);
+	palette_rest_mask |= PALETTE_MASK_SLOT(slot);
+	palette_pending_mask |= PALETTE_MASK_SLOT(slot);
+
+}
+
+void track_palette(uint8_t slot, const palette_color_t* palette) FADE_BANKED_FN { // add to LUT and WRAM back-buffer, uploaded in the next VBlank
+
+#ifdef FADE_BANKED
+	palette_bank_LUT[slot] = 0;
+#endif
+
+	track_colors(slot, palette, palette);
+
+}
+
+bool track_palette_cached(uint8_t slot, const palette_color_t* palette, const palette_color_t* to) FADE_BANKED_FN { // track_palette() plus WRAM ladders to `to` and back, FALSE if the cache is full
+
+	track_palette(slot, palette);
+
+	if (!fade_cache_ladder(palette, to)) return FALSE;
+	return fade_cache_ladder(to, palette);
+
+}
+
+#ifdef FADE_BANKED
+void palette_copy_banked(palette_color_t* dest, const palette_color_t* src, uint8_t bank) FADE_HOME_FN { // one palette out of any ROM bank, from bank 0 so the switch doesnt unmap the caller
+
+	uint8_t saved_bank = CURRENT_BANK;
+
+	SWITCH_ROM(bank);
+	memcpy(dest, src, PALETTE_BYTES);
+	SWITCH_ROM(saved_bank);
+
+}
+
+void track_palette_banked(uint8_t slot, const palette_color_t* palette, uint8_t bank) FADE_BANKED_FN { // track_palette() for a palette in any ROM bank
+
+	// NOTE: the LUT keeps (bank, palette), fades back to it and acquire_palette_banked() match on both, the engine reads a WRAM copy
+
+	if (bank == 0 || bank == FADE_ROM_BANK) { // NOTE: read in place, baked ladders match it
+		track_palette(slot, palette);
+		return;
+	}
+
+	palette_copy_banked(PALETTE_SLOT(palette_home, slot), palette, bank);
+	palette_bank_LUT[slot] = bank;
+
+	track_colors(slot, palette, PALETTE_SLOT(palette_home, slot));
+
+}
+#endif
+
+void untrack_palette(uint8_t slot) FADE_BANKED_FN { // drop from LUT, the hardware palette keeps its colors
+
+	palette_anim_stop(PALETTE_MASK_SLOT(slot));
+	stop_fades(PALETTE_MASK_SLOT(slot)); // NOTE: no fade or track goes on writing a freed slot
+
+	current_palettes_LUT[slot] = NULL;
+	palette_refcount[slot] = 0;
+#ifdef FADE_BANKED
+	palette_bank_LUT[slot] = 0;
+#endif
+
+	palette_tracked_mask &= ~PALETTE_MASK_SLOT(slot);
+	palette_rest_mask &= ~PALETTE_MASK_SLOT(slot);
+
+}
+
+uint8_t acquire_palette_banked(uint8_t layer, const palette_color_t* palette, uint8_t bank) FADE_BANKED_FN { // slot-index holding palette from ROM bank, shared if the layer already has it, PALETTE_SLOT_NONE if full
+
+	uint8_t unused = PALETTE_SLOT_NONE;
+
+#ifdef FADE_BANKED
+	if (bank == FADE_ROM_BANK) bank = 0; // NOTE: read in place, as track_palette_banked() stores it
+#else
+	bank = 0; // one address space
+#endif
+
+	for (uint8_t slot = layer; slot < layer + MAX_HARDWARE_PALETTES; slot++) {
+		if (PALETTE_ALLOC_RESERVED & PALETTE_MASK_SLOT(slot)) continue;
+
+		if (!(palette_tracked_mask & PALETTE_MASK_SLOT(slot))) {
+			if (unused == PALETTE_SLOT_NONE) unused = slot;
+		} else if (palette_refcount[slot] != 0 && current_palettes_LUT[slot] == palette && palette_bank(slot) == bank) { // NOTE: slots from track_palette() are left alone
+			palette_refcount[slot]++;
+			return slot;
+		}
+	}
+
+	if (unused == PALETTE_SLOT_NONE) return PALETTE_SLOT_NONE;
+
+	track_palette_banked(unused, palette, bank);
+	palette_refcount[unused] = 1;
+
+	return unused;
+
+}
+
+void release_palette(uint8_t slot) FADE_BANKED_FN { // the last user frees the slot
+
+	if (palette_refcount[slot] == 0) return;
+	if (--palette_refcount[slot] == 0) untrack_palette(slot);
+
+}
+
+//+ ------------------------------  SHADOW  ------------------------------- +//
+
+void shadow_set_palette(uint8_t slot, const palette_color_t* colors) FADE_BANKED_FN { // write colors through the shadow, instead of set_*_palette(), fades out but has no palette to fade back to
+
+	palette_anim_stop(PALETTE_MASK_SLOT(slot));
+
+	memcpy(PALETTE_SLOT(palette_shadow, slot), colors, PALETTE_BYTES);
+
+	current_palettes_LUT[slot] = NULL;
+
+	palette_tracked_mask |= PALETTE_MASK_SLOT(slot);
+	palette_rest_mask &= ~PALETTE_MASK_SLOT(slot);
+	palette_pending_mask |= PALETTE_MASK_SLOT(slot);
+
+}
+
+static void read_palette_ram(uint8_t slot, palette_color_t* dest) { // one palette from BCPD/OCPD, a byte at a time
+
+	uint8_t* out = (uint8_t*)dest;
+	uint8_t index = PALETTE_IDX(slot) * PALETTE_BYTES;
+	bool is_sprite = (slot >= MAX_HARDWARE_PALETTES);
+
+	for (uint8_t i = 0; i < PALETTE_BYTES; i++, index++) {
+		CRITICAL { // NOTE: the VBL handler moves BCPS/OCPS too
+			while (STAT_REG & STATF_BUSY); // NOTE: palette RAM reads 0xFF while the line is drawn
+
+			if (is_sprite) {
+				OCPS_REG = index; // NOTE: reads never auto-increment, set the index every byte
+				*out++ = OCPD_REG;
+			} else {
+				BCPS_REG = index;
+				*out++ = BCPD_REG;
+			}
+		}
+	}
+
+}
+
+void shadow_snapshot(uint16_t mask) FADE_BANKED_FN { // load the shadow from palette RAM, for palettes set behind its back
+
+	mask &= ~(palette_pending_mask | palette_dirty_mask); // NOTE: these are newer in the shadow than on screen
+
+	uint16_t bit = 0x0001;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1, bit <<= 1) {
+		if (!((uint8_t)mask & 0x01)) continue;
+
+		read_palette_ram(slot, PALETTE_SLOT(palette_shadow, slot));
+		current_palettes_LUT[slot] = NULL;
+
+		palette_tracked_mask |= bit;
+		palette_rest_mask &= ~bit;
+	}
+
+}
+
+void stage_palettes(void) FADE_BANKED_FN { // copy pending palettes from back- to front-buffer, uploaded by palette_vbl_isr()
+
+	if (palette_pending_mask == 0) return;
+	if (palette_dirty_mask != 0) return; // NOTE: front-buffer not flushed yet, retry next frame
+
+	PROFILE_BEGIN(PROFILE_STAGE);
+
+	uint16_t mask = palette_pending_mask;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1) {
+		if ((uint8_t)mask & 0x01) memcpy(PALETTE_SLOT(palette_front, slot), PALETTE_SLOT(palette_shadow, slot), PALETTE_BYTES);
+	}
+
+	CRITICAL {
+		palette_dirty_mask |= palette_pending_mask; // NOTE: animation tracks may have added theirs
+	}
+	palette_pending_mask = 0;
+
+	PROFILE_END(PROFILE_STAGE);
+
+}
+
+void fade_use_ladders(const fade_ladder_t* ladders, uint8_t count) FADE_BANKED_FN { // baked ladders from tools/palc.c, checked by every fade_palettes()
+
+	fade_ladders = ladders;
+	fade_ladders_count = count;
+
+}
+
+static const fade_ladder_t* lookup_ladder(const palette_color_t* from, const palette_color_t* to) { // matching ladder, baked or cached, or NULL
+
+	if (from == NULL) return NULL; // NOTE: shadow not at rest, no ladder starts there
+
+	for (uint8_t i = 0; i < fade_ladders_count; i++) {
+		if (fade_ladders[i].from == from && fade_ladders[i].to == to) return &fade_ladders[i];
+	}
+
+	uint8_t bit = 0x01;
+
+	for (uint8_t i = 0; i < FADE_CACHE_LADDERS; i++, bit <<= 1) {
+		if (!(fade_cache_ready_mask & bit)) continue; // NOTE: still building, the kernel covers this fade
+		if (fade_cache[i].from == from && fade_cache[i].to == to) return &fade_cache[i];
+	}
+
+	return NULL;
+
+}
+
+static const palette_color_t* find_ladder(uint8_t slot, const palette_color_t* from, const palette_color_t* to) { // levels of a matching ladder for a fading slot, or NULL
+
+	if (palette_colors(slot, from) != from || palette_colors(slot, to) != to) return NULL; // NOTE: another ROM bank, its address can alias a ladder's palette
+
+	const fade_ladder_t* ladder = lookup_ladder(from, to);
+	if (ladder == NULL) return NULL;
+
+	fade_ladder_level[slot] = 0;
+	fade_ladder_end[slot] = ladder->end;
+
+	return ladder->levels;
+
+}
+
+const palette_color_t* fade_ladder_colors(const palette_color_t* from, const palette_color_t* to, uint8_t level) FADE_BANKED_FN { // colors part-way along a baked or cached fade, for raster wipes, NULL without a ladder
+
+	const fade_ladder_t* ladder = lookup_ladder(from, to);
+	if (ladder == NULL) return NULL;
+
+	if (level > ladder->end) level = ladder->end;
+
+	return PALETTE_SLOT(ladder->levels, level);
+
+}
+
+//+ ------------------------------  CACHE  -------------------------------- +//
+
+bool fade_cache_ladder(const palette_color_t* from, const palette_color_t* to) FADE_BANKED_FN { // claim a WRAM ladder, built lazily by fade_update(), FALSE if the cache is full
+
+	uint8_t bit = 0x01;
+	uint8_t unused = 0xFF;
+
+	for (uint8_t i = 0; i < FADE_CACHE_LADDERS; i++, bit <<= 1) {
+		if (!(fade_cache_used_mask & bit)) {
+			if (unused == 0xFF) unused = i;
+		} else if (fade_cache[i].from == from && fade_cache[i].to == to) {
+			return TRUE;
+		}
+	}
+
+	if (unused == 0xFF) return FALSE;
+
+	fade_cache[unused].from = from;
+	fade_cache[unused].to = to;
+	fade_cache[unused].levels = fade_cache_levels[unused];
+	fade_cache_built[unused] = 0;
+
+	fade_cache_used_mask |= (uint8_t)(1 << unused);
+
+	return TRUE;
+
+}
+
+void fade_cache_invalidate(const palette_color_t* palette) FADE_BANKED_FN { // rebuild every ladder from or to an edited palette
+
+	uint8_t bit = 0x01;
+
+	for (uint8_t i = 0; i < FADE_CACHE_LADDERS; i++, bit <<= 1) {
+		if (!(fade_cache_used_mask & bit)) continue;
+		if (fade_cache[i].from != palette && fade_cache[i].to != palette) continue;
+
+		fade_cache_built[i] = 0;
+		fade_cache_ready_mask &= ~bit;
+	}
+
+}
+
+static uint8_t fade_cache_busy_mask(void) { // cache entries a running fade reads its levels from
+
+	uint8_t busy = 0;
+
+	for (uint8_t id = 0; id < FADE_MAX_RUNNING; id++) {
+		if (!(fade_running_mask & (uint8_t)(1 << id))) continue;
+
+		uint16_t mask = fades[id].slots_mask;
+
+		for (uint8_t slot = 0; mask; slot++, mask >>= 1) {
+			if (!((uint8_t)mask & 0x01)) continue;
+			if (fade_ladder_LUT[slot] == NULL) continue;
+
+			for (uint8_t i = 0; i < FADE_CACHE_LADDERS; i++) {
+				if (fade_ladder_LUT[slot] == fade_cache_levels[i]) busy |= (uint8_t)(1 << i);
+			}
+		}
+	}
+
+	return busy;
+
+}
+
+void fade_cache_clear(void) FADE_BANKED_FN { // NOTE: ladders still read by a running fade stay, freed by the next clear once it ends
+
+	uint8_t busy = fade_cache_busy_mask();
+
+	fade_cache_used_mask &= busy;
+	fade_cache_ready_mask &= busy;
+
+}
+
+static void fade_cache_build(void) { // a few levels of the first unfinished ladder, level k = level k-1 stepped by 1
+
+	uint8_t pending = fade_cache_used_mask & ~fade_cache_ready_mask;
+	if (pending == 0) return;
+
+	uint8_t i = 0;
+	uint8_t bit = 0x01;
+	while (!(pending & bit)) { i++; bit <<= 1; }
+
+	fade_ladder_t* ladder = &fade_cache[i];
+	palette_color_t* levels = fade_cache_levels[i];
+
+	for (uint8_t n = 0; n < FADE_CACHE_LEVELS_PER_FRAME; n++) {
+		uint8_t level = fade_cache_built[i];
+		bool converged;
+
+		if (level == 0) {
+			memcpy(levels, ladder->from, PALETTE_BYTES);
+			converged = fade_palette_toward(levels, ladder->to, 0); // NOTE: step 0 only compares
+		} else {
+			memcpy(PALETTE_SLOT(levels, level), PALETTE_SLOT(levels, level - 1), PALETTE_BYTES);
+			converged = fade_palette_toward(PALETTE_SLOT(levels, level), ladder->to, 1);
+		}
+
+		fade_cache_built[i] = level + 1;
+
+		if (converged) { // NOTE: later levels would all be `to`, never read
+			ladder->end = level;
+			fade_cache_ready_mask |= bit;
+			return;
+		}
+	}
+
+}
+
+static uint8_t find_alias(uint8_t slot, uint16_t slots_mask) { // earlier slot of the same fade with the same start and target, its result is reused
+
+	uint16_t bit = 0x0001;
+
+	for (uint8_t leader = 0; leader < slot; leader++, bit <<= 1) {
+		if (!(slots_mask & bit)) continue;
+		if (fade_alias_LUT[leader] != PALETTE_SLOT_NONE) continue;
+		if (fade_target_LUT[leader] != fade_target_LUT[slot] && memcmp(fade_target_LUT[leader], fade_target_LUT[slot], PALETTE_BYTES) != 0) continue;
+		if (memcmp(PALETTE_SLOT(palette_shadow, leader), PALETTE_SLOT(palette_shadow, slot), PALETTE_BYTES) != 0) continue;
+
+		return leader;
+	}
+
+	return PALETTE_SLOT_NONE;
+
+}
+
+static void fade_speed(fade_t* fade) { // double speed while FADE_FAST_MIN_SLOTS palettes need the kernel, ladders and aliases are cheap
+
+	uint8_t count = 0;
+	uint16_t mask = fade->active_mask;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1) {
+		if (!((uint8_t)mask & 0x01)) continue;
+		if (fade_ladder_LUT[slot] == NULL && fade_alias_LUT[slot] == PALETTE_SLOT_NONE) count++;
+	}
+
+	bool is_fast = (count >= FADE_FAST_MIN_SLOTS);
+	if (is_fast == fade->is_fast) return;
+
+	fade->is_fast = is_fast;
+	if (is_fast) speed_push_fast();
+	else speed_pop();
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ANIMATION  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static uint8_t claim_anim(uint8_t slot) { // free track, after stopping the one already on slot, PALETTE_ANIM_NONE if all are busy
+
+	palette_anim_stop(PALETTE_MASK_SLOT(slot));
+
+	for (uint8_t i = 0; i < PALETTE_ANIM_TRACKS; i++) {
+		if (!(palette_anim_mask & (uint8_t)(1 << i))) return i;
+	}
+
+	return PALETTE_ANIM_NONE;
+
+}
+
+uint8_t palette_anim_rotate(uint8_t slot, uint8_t first, uint8_t count, uint8_t period, bool is_pingpong) FADE_BANKED_FN { // cycle colors first..first+count-1 by one every period frames, water, lava
+
+	if (count < 2 || first + count > PALETTE_SIZE) return PALETTE_ANIM_NONE;
+
+	uint8_t i = claim_anim(slot);
+	if (i == PALETTE_ANIM_NONE) return PALETTE_ANIM_NONE;
+
+	stop_fades(PALETTE_MASK_SLOT(slot));
+
+	palette_anim_t* anim = &palette_anims[i];
+
+	anim->slot = slot;
+	anim->type = is_pingpong ? PALETTE_ANIM_PINGPONG : PALETTE_ANIM_ROTATE;
+	anim->period = (period == 0) ? 1 : period;
+	anim->counter = anim->period;
+	anim->first = first;
+	anim->count = count;
+	anim->phase = count - 1; // NOTE: pingpong turns after a full cycle
+	anim->is_backward = FALSE;
+
+	CRITICAL {
+		palette_anim_slots_mask |= PALETTE_MASK_SLOT(slot);
+		palette_anim_mask |= (uint8_t)(1 << i);
+	}
+
+	return i;
+
+}
+
+uint8_t palette_anim_flash(uint8_t slot, palette_color_t color, uint8_t frames) FADE_BANKED_FN { // every color of slot to color for frames, then back, hit flashes
+
+	uint8_t i = claim_anim(slot);
+	if (i == PALETTE_ANIM_NONE) return PALETTE_ANIM_NONE;
+
+	stop_fades(PALETTE_MASK_SLOT(slot));
+
+	palette_anim_t* anim = &palette_anims[i];
+	palette_color_t* colors = PALETTE_SLOT(palette_shadow, slot);
+
+	memcpy(anim->saved, colors, PALETTE_BYTES);
+	for (uint8_t c = 0; c < PALETTE_SIZE; c++) colors[c] = color;
+
+	anim->slot = slot;
+	anim->type = PALETTE_ANIM_FLASH;
+	anim->period = 1;
+	anim->counter = 1;
+	anim->phase = (frames == 0) ? 1 : frames;
+
+	CRITICAL { // NOTE: staged here, not waiting for stage_palettes(), the VBL handler starts the countdown once it is uploaded
+		memcpy(PALETTE_SLOT(palette_front, slot), colors, PALETTE_BYTES);
+		palette_dirty_mask |= PALETTE_MASK_SLOT(slot);
+
+		palette_anim_slots_mask |= PALETTE_MASK_SLOT(slot);
+		palette_anim_mask |= (uint8_t)(1 << i);
+	}
+
+	return i;
+
+}
+
+void palette_anim_stop(uint16_t slots_mask) FADE_BANKED_FN { // stop the tracks on these slots, a flash puts its colors back
+
+	if (!(palette_anim_slots_mask & slots_mask)) return;
+
+	for (uint8_t i = 0; i < PALETTE_ANIM_TRACKS; i++) {
+		uint8_t bit = (uint8_t)(1 << i);
+		palette_anim_t* anim = &palette_anims[i];
+
+		if (!(palette_anim_mask & bit)) continue;
+		if (!(slots_mask & PALETTE_MASK_SLOT(anim->slot))) continue;
+
+		CRITICAL {
+			palette_anim_mask &= ~bit;
+			palette_anim_slots_mask &= ~PALETTE_MASK_SLOT(anim->slot);
+		}
+
+		if (anim->type == PALETTE_ANIM_FLASH) {
+			memcpy(PALETTE_SLOT(palette_shadow, anim->slot), anim->saved, PALETTE_BYTES);
+			palette_pending_mask |= PALETTE_MASK_SLOT(anim->slot);
+		}
+	}
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static inline void fade_step_gbc(fade_t* fade, uint8_t step) { // one fade-step of every palette of a fade that hasnt converged yet, called by fade_update()
+
+	uint16_t stepped_mask = fade->active_mask; // NOTE: palettes converging in this step still need this upload
+	uint16_t mask = fade->slots_mask;
+	uint16_t bit = 0x0001;
+
+	PROFILE_BEGIN(PROFILE_COMPUTE);
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1, bit <<= 1) { // NOTE: stops after the highest slot in use, other slots cost nothing
+		if (!((uint8_t)mask & 0x01)) continue;
+
+		if (!(stepped_mask & bit)) {
+			fade_skipped_uploads++;
+		} else if (fade_alias_LUT[slot] != PALETTE_SLOT_NONE) { // NOTE: duplicate, copy the result of its leader (always an earlier slot)
+			uint8_t leader = fade_alias_LUT[slot];
+
+			memcpy(PALETTE_SLOT(palette_shadow, slot), PALETTE_SLOT(palette_shadow, leader), PALETTE_BYTES);
+			if (!(fade->active_mask & PALETTE_MASK_SLOT(leader))) fade->active_mask &= ~bit;
+		} else if (fade_ladder_LUT[slot] != NULL) { // NOTE: baked, no color math
+			uint8_t level = fade_ladder_level[slot] + step;
+
+			if (level >= fade_ladder_end[slot]) {
+				level = fade_ladder_end[slot];
+				fade->active_mask &= ~bit;
+			}
+
+			fade_ladder_level[slot] = level;
+			memcpy(PALETTE_SLOT(palette_shadow, slot), PALETTE_SLOT(fade_ladder_LUT[slot], level), PALETTE_BYTES);
+		} else {
+			if (fade_palette_toward(PALETTE_SLOT(palette_shadow, slot), fade_target_LUT[slot], step)) fade->active_mask &= ~bit;
+		}
+	}
+
+	PROFILE_END(PROFILE_COMPUTE);
+
+	palette_pending_mask |= stepped_mask;
+
+}
+
+uint8_t fade_palettes_masked(const palette_color_t* const* from, const palette_color_t* const* to, uint8_t frames, uint8_t bkg_mask, uint8_t sprite_mask) FADE_BANKED_FN { // fade the selected tracked palettes between any two palette sets, FADE_ID_NONE if none are free
+
+	// NOTE: from == NULL starts from the shadow (what is on screen), no copy, also retargets running fades without a pop
+	// NOTE: slots taken from other running fades leave them, the rest of those fades carries on
+
+	uint16_t slots_mask = (((uint16_t)sprite_mask << 8) | bkg_mask) & palette_tracked_mask;
+
+	uint16_t mask = slots_mask;
+	uint16_t bit = 0x0001;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1, bit <<= 1) { // NOTE: slots without a palette to fade to or from are left alone
+		if (!((uint8_t)mask & 0x01)) continue;
+		if (to[slot] == NULL || (from != NULL && from[slot] == NULL)) slots_mask &= ~bit;
+	}
+
+	if (slots_mask == 0) return FADE_ID_NONE;
+
+	uint8_t id = FADE_ID_NONE;
+
+	for (uint8_t i = 0; i < FADE_MAX_RUNNING; i++) { // NOTE: a fade this one takes every slot from is free too
+		if (!(fade_running_mask & (uint8_t)(1 << i)) || !(fades[i].slots_mask & ~slots_mask)) { id = i; break; }
+	}
+
+	if (id == FADE_ID_NONE) return FADE_ID_NONE; // NOTE: before touching anything, running fades and tracks carry on
+
+	palette_anim_stop(slots_mask); // NOTE: the fade takes over animated slots, a flash is undone first
+	stop_fades(slots_mask);
+
+	fade_t* fade = &fades[id];
+
+	if (frames == 0) frames = 1;
+
+	PROFILE_RESET(); // NOTE: stats per fade
+	PROFILE_BEGIN(PROFILE_COPY);
+
+	fade->slots_mask = 0;
+	fade->rest_mask = 0;
+
+	mask = slots_mask;
+	bit = 0x0001;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1, bit <<= 1) {
+		if (!((uint8_t)mask & 0x01)) continue;
+
+		if (from != NULL) {
+			memcpy(PALETTE_SLOT(palette_shadow, slot), palette_colors(slot, from[slot]), PALETTE_BYTES);
+			palette_pending_mask |= bit; // NOTE: show the start, even when the first frames dont move
+		}
+		fade_target_LUT[slot] = palette_colors(slot, to[slot]);
+		if (from != NULL) {
+			fade_origin_LUT[slot] = from[slot];
+		} else {
+			fade_origin_LUT[slot] = (palette_rest_mask & bit) ? current_palettes_LUT[slot] : NULL; // NOTE: mid-fade or untracked colors have no palette to return to
+		}
+		fade_ladder_LUT[slot] = find_ladder(slot, fade_origin_LUT[slot], to[slot]);
+		if (to[slot] == current_palettes_LUT[slot]) fade->rest_mask |= bit;
+		fade_alias_LUT[slot] = find_alias(slot, fade->slots_mask);
+		fade->slots_mask |= bit;
+	}
+
+	PROFILE_END(PROFILE_COPY);
+
+	palette_rest_mask &= ~fade->slots_mask;
+	fade->active_mask = fade->slots_mask;
+
+	fade_pace_init(&fade->pace, frames);
+	fade->frames_left = frames;
+	fade->frames_total = frames;
+
+	fade_running_mask |= (uint8_t)(1 << id);
+	is_fading = TRUE;
+
+	fade_speed(fade);
+
+	return id;
+
+}
+
+uint8_t fade_palettes(const palette_color_t* const* from, const palette_color_t* const* to, uint8_t frames, uint16_t exclude_mask) FADE_BANKED_FN { // fade every tracked palette but the excluded ones
+
+	return fade_palettes_masked(from, to, frames, (uint8_t)~exclude_mask, (uint8_t)(~exclude_mask >> 8));
+
+}
+
+void fade_reverse_id(uint8_t id) FADE_BANKED_FN { // turn a running fade around, back to where it started, from the current colors
+
+	// NOTE: the full duration again, at the same speed, ends early once every palette is back
+
+	if (id >= FADE_MAX_RUNNING) return;
+	if (!(fade_running_mask & (uint8_t)(1 << id))) return;
+
+	fade_t* fade = &fades[id];
+
+	fade->rest_mask = 0;
+
+	uint16_t mask = fade->slots_mask;
+	uint16_t bit = 0x0001;
+
+	for (uint8_t slot = 0; mask; slot++, mask >>= 1, bit <<= 1) {
+		if (!((uint8_t)mask & 0x01)) continue;
+
+		const palette_color_t* origin = fade_origin_LUT[slot];
+
+		if (origin == NULL) { // NOTE: nowhere to return to, stops on its current colors
+			release_slots(fade, bit);
+			continue;
+		}
+
+		fade_origin_LUT[slot] = fade_target_LUT[slot];
+		fade_target_LUT[slot] = palette_colors(slot, origin);
+		fade_ladder_LUT[slot] = NULL; // NOTE: between ladder levels, the kernel takes over
+
+		if (origin == current_palettes_LUT[slot]) fade->rest_mask |= bit;
+	}
+
+	fade->active_mask = fade->slots_mask;
+
+	fade_pace_init(&fade->pace, fade->frames_total);
+	fade->frames_left = fade->frames_total;
+
+	if (fade->slots_mask == 0) end_fade(id);
+	else fade_speed(fade); // NOTE: ladders dropped, every palette on the kernel now
+
+}
+
+void fade_reverse(void) FADE_BANKED_FN { // every running fade
+
+	for (uint8_t id = 0; id < FADE_MAX_RUNNING; id++) fade_reverse_id(id);
+
+}
+
+bool fade_is_running(uint8_t id) FADE_BANKED_FN {
+
+	if (id >= FADE_MAX_RUNNING) return FALSE;
+	return (fade_running_mask & (uint8_t)(1 << id)) != 0;
+
+}
+
+uint8_t fade_start(uint8_t direction, uint16_t exclude_mask) FADE_BANKED_FN { // the 4 classic fades, over FADE_FRAMES_GBC
+
+	switch (direction) {
+		case FADE_TO_BLACK: return fade_palettes(NULL, palette_set_black, FADE_FRAMES_GBC, exclude_mask); // NOTE: from the shadow, what is on screen
+		case FADE_TO_WHITE: return fade_palettes(NULL, palette_set_white, FADE_FRAMES_GBC, exclude_mask);
+		case FADE_FROM_BLACK: return fade_palettes(palette_set_black, current_palettes_LUT, FADE_FRAMES_GBC, exclude_mask);
+		case FADE_FROM_WHITE: return fade_palettes(palette_set_white, current_palettes_LUT, FADE_FRAMES_GBC, exclude_mask);
+	}
+
+	return FADE_ID_NONE;
+
+}
+
+uint8_t fade_transform(const palette_color_t* ramp, uint8_t frames, uint8_t bkg_mask, uint8_t sprite_mask) FADE_BANKED_FN { // blend palettes into their luma mapped through ramp: greyscale, sepia, tints
+
+	// NOTE: mapped from each slot's const palette, or the shadow without one, then a normal fade: same cost per step
+	// NOTE: back with fade_palettes_masked(NULL, current_palettes_LUT, ...), or fade_reverse_id()
+
+	uint16_t mask = (((uint16_t)sprite_mask << 8) | bkg_mask) & palette_tracked_mask;
+	uint16_t bit = 0x0001;
+
+	for (uint8_t slot = 0; slot < PALETTE_SLOTS; slot++, bit <<= 1) {
+		if (!(mask & bit)) {
+			fade_transform_LUT[slot] = NULL;
+			continue;
+		}
+
+		const palette_color_t* source = current_palettes_LUT[slot];
+		source = (source == NULL) ? PALETTE_SLOT(palette_shadow, slot) : palette_colors(slot, source);
+
+		fade_palette_map(PALETTE_SLOT(fade_transform_buffer, slot), source, ramp);
+		fade_transform_LUT[slot] = PALETTE_SLOT(fade_transform_buffer, slot);
+	}
+
+	return fade_palettes_masked(NULL, fade_transform_LUT, frames, bkg_mask, sprite_mask);
+
+}
+
+void fade_update(void) FADE_BANKED_FN { // call once per frame, runs at most one fade-step of every running fade and returns
+
+	stage_palettes(); // NOTE: retry palettes that couldnt be staged last frame
+
+	if (!is_fading) {
+		fade_cache_build(); // NOTE: only between fades, keeps fade frames flat
+		return;
+	}
+
+	for (uint8_t id = 0; id < FADE_MAX_RUNNING; id++) {
+		if (!(fade_running_mask & (uint8_t)(1 << id))) continue;
+
+		fade_t* fade = &fades[id];
+
+		uint8_t step = fade_pace_step(&fade->pace);
+
+		if (step > 0) fade_step_gbc(fade, step); // NOTE: slow fades skip the frames without movement
+
+		fade->frames_left--;
+
+		if (fade->frames_left > 0 && fade->active_mask != 0) continue; // NOTE: early-exit once every palette converged
+
+		end_fade(id);
+
+		PROFILE_REPORT();
+	}
+
+	stage_palettes(); // NOTE: one staging for every fade of this frame
+
+}
@@ -0,0 +1,261 @@
+#ifndef FADE_H
+#define FADE_H
+
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+
+#include "fade_math.h" // PALETTE_SIZE, FADE_DISTANCE, kernels
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Palette fade engine for GBC.
+
+	All 16 hardware palettes are addressed as one slot-index: 0-7 bkg, 8-15 sprites.
+	Every 16-bit palette mask uses the same layout, so one driver walks both layers.
+
+	Usage:
+		- `fade_init()` once, registers the VBL handler that uploads palettes.
+		- `track_bkg_palette()` / `track_sprite_palette()` per scene, instead of `set_*_palette()`,
+		  or `acquire_bkg_palette()` / `acquire_sprite_palette()` to get a free (or shared) slot,
+		  reference counted, `release_palette()` once unused.
+		- slots starting and ending a fade on the same colors share one computation, the
+		  duplicates copy the result.
+		- every palette write goes through the 128 byte shadow of palette RAM (`palette_shadow`),
+		  `shadow_set_palette()` for colors without a const palette, `shadow_snapshot()` to read
+		  back palettes set behind its back. Fades from the screen start there, no copy.
+		- `fade_palettes_masked()` fades only the bkg/sprite palettes in its masks, up to FADE_MAX_RUNNING
+		  fades run at once with their own targets and speeds, each returns an id. Starting a fade
+		  takes its palettes out of the running ones, the rest of those keep going.
+		- `fade_transform()` blends palettes into greyscale, sepia or a tint (`fade_ramp_grey`,
+		  `fade_ramp_sepia`, `fade_ramp_red`, or any 32-color ramp indexed by luma), on the same engine.
+		- `fade_reverse()` turns the running fades around from their current colors (`fade_reverse_id()`
+		  just one), `fade_palettes()` with from == NULL retargets palettes mid-fade, both take effect
+		  on the next `fade_update()`.
+		- `palette_anim_rotate()` (cycling, ping-pong) and `palette_anim_flash()` run per-slot tracks,
+		  ticked by the VBL handler and uploaded in the same batch as everything else. A track owns
+		  its slot: fades, `track_palette()` and `shadow_set_palette()` on it stop the track first.
+		- `fade_palettes()` between any two palette sets, or `fade_start()` for black/white, then `fade_update()` once per frame.
+		- fades with FADE_FAST_MIN_SLOTS palettes or more on the kernel hold double speed until they
+		  end (src/speed.h), main loop calls `speed_update()`.
+		- optional `fade_use_ladders()` with the ladders baked by tools/palc.c: matching fades copy
+		  precomputed levels instead of running the kernel, same result, fixed cost per step.
+		- optional `fade_cache_ladder()` for palettes made at runtime: same ladders, built in WRAM
+		  while no fade runs, a few levels per frame. `fade_cache_invalidate()` after editing one.
+		  `track_palette_cached()` registers a palette with its ladders to a target and back.
+		  `clear_palettes_LUT()` empties the cache for the next scene, but a ladder a running fade
+		  still reads stays until the next clear.
+		- `make MBC=5` builds the engine, its const data and build/gen/palettes.c into ROM bank
+		  FADE_BANK, public routines are BANKED, the VBL handler stays in bank 0. Palettes from other
+		  banks go through `track_palette_banked()` / `acquire_palette_banked()` with their bank
+		  (`BANK()` of a `BANKREF()`): the LUT keeps the pointer and its bank, the engine reads a WRAM
+		  copy. Fade ramps and `fade_cache_ladder()` palettes are read in place, from bank 0,
+		  FADE_ROM_BANK or WRAM. Pointers to engine data read outside of it, like
+		  `fade_ladder_colors()` in raster tables, go with bank FADE_ROM_BANK.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -------------------------------------  COMMON MACROS  ------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+//+ --  PALETTES  -- +//
+
+#define MAX_HARDWARE_PALETTES 8 // 8 palettes for sprites, 8 palettes for bkg
+#define PALETTE_SLOTS (MAX_HARDWARE_PALETTES * 2) // bkg and sprite palettes, as one slot-index
+
+#define PALETTE_BYTES (PALETTE_SIZE * sizeof(uint16_t)) // total bytes of one palette
+
+#define PALETTE_SLOT(buffer, idx) (&(buffer)[(idx) * PALETTE_SIZE]) // palette idx inside a contiguous palette buffer
+
+#define PALETTE_SLOT_BKG(idx) (idx) // slot-index of a hardware palette
+#define PALETTE_SLOT_SPRITE(idx) (MAX_HARDWARE_PALETTES + (idx))
+
+#define PALETTE_MASK_SLOT(slot) ((uint16_t)1 << (slot)) // bit of a slot in the 16-bit palette masks
+#define PALETTE_MASK_BKG(idx) ((uint16_t)1 << (idx))
+#define PALETTE_MASK_SPRITE(idx) ((uint16_t)0x0100 << (idx))
+
+#define PALETTE_SLOT_NONE 0xFF // no slot: layer full, or no alias
+#define PALETTE_IDX(slot) ((slot) & 0x07) // hardware palette idx of a slot-index, for oam/bkg attributes
+
+#define PALETTE_LAYER_BKG PALETTE_SLOT_BKG(0) // first slot-index of a layer, for acquire_palette()
+#define PALETTE_LAYER_SPRITE PALETTE_SLOT_SPRITE(0)
+
+#ifndef PALETTE_ALLOC_RESERVED
+#define PALETTE_ALLOC_RESERVED (PALETTE_MASK_BKG(0) | PALETTE_MASK_SPRITE(0)) // never handed out by acquire_palette(): text and default palettes
+#endif
+
+#define PALETTE_MASK_ALL_BKG 0x00FF
+#define PALETTE_MASK_ALL_SPRITES 0xFF00
+
+#define PALETTE_SET_OF(palette) { \
+	palette, palette, palette, palette, palette, palette, palette, palette, \
+	palette, palette, palette, palette, palette, palette, palette, palette \
+} // palette set with the same palette in every slot
+
+//+ --  BANKING  -- +//
+
+#ifdef FADE_BANKED // make MBC=5
+#define FADE_BANKED_FN BANKED // public routines, called through a trampoline from any bank
+#define FADE_HOME_FN NONBANKED // VBL handler and bank switching, kept in bank 0
+#define FADE_ROM_BANK BANK(fade) // bank of the engine, its const palettes and the baked ladders
+#else
+#define FADE_BANKED_FN
+#define FADE_HOME_FN
+#define FADE_ROM_BANK 0 // 0: nothing to switch
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  FADE MACROS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define FADE_FRAMES_GBC 24 // duration of the classic fades, same pace as the old 8 steps of 4, every 3 frames
+
+#define FADE_TO_BLACK 1 // direction for fade_start()
+#define FADE_TO_WHITE 2
+#define FADE_FROM_BLACK 3
+#define FADE_FROM_WHITE 4
+
+#ifndef FADE_CACHE_LADDERS
+#define FADE_CACHE_LADDERS 4 // WRAM ladder cache entries, 256 bytes each, max 8
+#endif
+#define FADE_CACHE_LEVELS_PER_FRAME 4 // cache build pace, kernel calls per idle frame
+
+#ifndef PALETTE_UPLOAD_LAST_LINE
+#define PALETTE_UPLOAD_LAST_LINE 152 // VBL handler stops starting palette writes here, line 153 is short and LY wraps early
+#endif
+#define PALETTE_UPLOAD_FIRST_LINE 144 // first VBlank line
+#define PALETTE_UPLOADS_PER_LINE 1 // palettes written per scanline at single speed, ~60 of 114 M-cycles, with margin
+
+#ifndef FADE_MAX_RUNNING
+#define FADE_MAX_RUNNING 4 // fades running at once, on separate palettes, max 8
+#endif
+#define FADE_ID_NONE 0xFF // no fade started
+
+#ifndef FADE_FAST_MIN_SLOTS
+#define FADE_FAST_MIN_SLOTS 6 // palettes on the kernel per fade that switch to double speed, 0: always, 17: never
+#endif
+
+#define FADE_MASK_ALL 0xFF // bkg_mask / sprite_mask for fade_palettes_masked(), one bit per hardware palette
+#define FADE_MASK_NONE 0x00
+
+#ifndef PALETTE_ANIM_TRACKS
+#define PALETTE_ANIM_TRACKS 8 // animation tracks running at once, max 8
+#endif
+#define PALETTE_ANIM_NONE 0xFF // no track started
+
+#define PALETTE_ANIM_ROTATE 1 // track types
+#define PALETTE_ANIM_PINGPONG 2
+#define PALETTE_ANIM_FLASH 3
+
+#define FADE_EXCLUDE_NONE 0x0000 // exclude_mask for fade_start()
+#define FADE_EXCLUDE_TEXT PALETTE_MASK_BKG(0) // keep bkg palette-0, for the background text
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+typedef struct { // baked fade between two const palettes, generated by tools/palc.c
+	const palette_color_t* from;
+	const palette_color_t* to;
+	const palette_color_t* levels; // FADE_DISTANCE + 1 palettes, level k = from stepped k toward to
+	uint8_t end; // first level equal to `to`
+} fade_ladder_t;
+
+extern bool is_fading; // any fade in progress, stepped by fade_update()
+
+extern uint16_t fade_skipped_uploads; // palette uploads saved by convergence tracking, since boot
+extern uint16_t palette_spilled_uploads; // VBlanks that ran out of time and deferred palettes to the next one, since boot
+extern volatile uint8_t palette_upload_reserve; // VBlank lines the upload leaves to later VBL handlers, set by src/attr.c while rows are dirty
+
+extern const palette_color_t* current_palettes_LUT[PALETTE_SLOTS]; // pointers, slot-index to currently used const palette
+
+#define current_bkg_palettes_LUT (&current_palettes_LUT[PALETTE_SLOT_BKG(0)])
+#define current_sprite_palettes_LUT (&current_palettes_LUT[PALETTE_SLOT_SPRITE(0)])
+
+extern uint16_t palette_tracked_mask; // bit per tracked palette, bits 0-7 bkg, bits 8-15 sprites
+
+extern palette_color_t palette_shadow[PALETTE_SLOTS * PALETTE_SIZE]; // WRAM mirror of palette RAM, read-only: write with shadow_set_palette()
+extern palette_color_t palette_front[PALETTE_SLOTS * PALETTE_SIZE]; // staged palettes, what the VBL handler uploads, read-only
+extern volatile uint16_t palette_restore_mask; // slots to upload again from palette_front in the next VBlank, after mid-frame writes (src/raster.c)
+
+extern const palette_color_t palette_all_black[];
+extern const palette_color_t palette_all_white[];
+
+extern const palette_color_t* const palette_set_black[PALETTE_SLOTS]; // palette sets: pointer per slot-index
+extern const palette_color_t* const palette_set_white[PALETTE_SLOTS];
+
+#ifdef FADE_BANKED
+BANKREF_EXTERN(fade)
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void fade_init(void) FADE_BANKED_FN;
+
+void clear_palettes_LUT(void) FADE_BANKED_FN;
+void track_palette(uint8_t slot, const palette_color_t* palette) FADE_BANKED_FN;
+bool track_palette_cached(uint8_t slot, const palette_color_t* palette, const palette_color_t* to) FADE_BANKED_FN;
+
+#ifdef FADE_BANKED
+void palette_copy_banked(palette_color_t* dest, const palette_color_t* src, uint8_t bank) FADE_HOME_FN;
+void track_palette_banked(uint8_t slot, const palette_color_t* palette, uint8_t bank) FADE_BANKED_FN;
+#else
+#define track_palette_banked(slot, palette, bank) track_palette((slot), (palette)) // one address space, nothing to copy
+#endif
+
+#define track_bkg_palette_banked(idx, palette, bank) track_palette_banked(PALETTE_SLOT_BKG(idx), (palette), (bank))
+#define track_sprite_palette_banked(idx, palette, bank) track_palette_banked(PALETTE_SLOT_SPRITE(idx), (palette), (bank))
+
+#define track_bkg_palette(idx, palette) track_palette(PALETTE_SLOT_BKG(idx), (palette))
+#define track_sprite_palette(idx, palette) track_palette(PALETTE_SLOT_SPRITE(idx), (palette))
+#define track_bkg_palette_cached(idx, palette, to) track_palette_cached(PALETTE_SLOT_BKG(idx), (palette), (to))
+#define track_sprite_palette_cached(idx, palette, to) track_palette_cached(PALETTE_SLOT_SPRITE(idx), (palette), (to))
+
+void untrack_palette(uint8_t slot) FADE_BANKED_FN;
+
+uint8_t acquire_palette_banked(uint8_t layer, const palette_color_t* palette, uint8_t bank) FADE_BANKED_FN;
+void release_palette(uint8_t slot) FADE_BANKED_FN;
+
+#define acquire_palette(layer, palette) acquire_palette_banked((layer), (palette), 0)
+
+#define acquire_bkg_palette(palette) acquire_palette(PALETTE_LAYER_BKG, (palette))
+#define acquire_sprite_palette(palette) acquire_palette(PALETTE_LAYER_SPRITE, (palette))
+#define acquire_bkg_palette_banked(palette, bank) acquire_palette_banked(PALETTE_LAYER_BKG, (palette), (bank))
+#define acquire_sprite_palette_banked(palette, bank) acquire_palette_banked(PALETTE_LAYER_SPRITE, (palette), (bank))
+
+void shadow_set_palette(uint8_t slot, const palette_color_t* colors) FADE_BANKED_FN;
+void shadow_snapshot(uint16_t mask) FADE_BANKED_FN;
+
+#define shadow_set_bkg_palette(idx, colors) shadow_set_palette(PALETTE_SLOT_BKG(idx), (colors))
+#define shadow_set_sprite_palette(idx, colors) shadow_set_palette(PALETTE_SLOT_SPRITE(idx), (colors))
+
+void stage_palettes(void) FADE_BANKED_FN;
+
+uint8_t palette_anim_rotate(uint8_t slot, uint8_t first, uint8_t count, uint8_t period, bool is_pingpong) FADE_BANKED_FN;
+uint8_t palette_anim_flash(uint8_t slot, palette_color_t color, uint8_t frames) FADE_BANKED_FN;
+void palette_anim_stop(uint16_t slots_mask) FADE_BANKED_FN;
+
+void fade_use_ladders(const fade_ladder_t* ladders, uint8_t count) FADE_BANKED_FN;
+const palette_color_t* fade_ladder_colors(const palette_color_t* from, const palette_color_t* to, uint8_t level) FADE_BANKED_FN;
+
+bool fade_cache_ladder(const palette_color_t* from, const palette_color_t* to) FADE_BANKED_FN;
+void fade_cache_invalidate(const palette_color_t* palette) FADE_BANKED_FN;
+void fade_cache_clear(void) FADE_BANKED_FN;
+
+uint8_t fade_palettes_masked(const palette_color_t* const* from, const palette_color_t* const* to, uint8_t frames, uint8_t bkg_mask, uint8_t sprite_mask) FADE_BANKED_FN;
+uint8_t fade_palettes(const palette_color_t* const* from, const palette_color_t* const* to, uint8_t frames, uint16_t exclude_mask) FADE_BANKED_FN;
+uint8_t fade_start(uint8_t direction, uint16_t exclude_mask) FADE_BANKED_FN;
+uint8_t fade_transform(const palette_color_t* ramp, uint8_t frames, uint8_t bkg_mask, uint8_t sprite_mask) FADE_BANKED_FN;
+
+void fade_reverse_id(uint8_t id) FADE_BANKED_FN;
+void fade_reverse(void) FADE_BANKED_FN;
+bool fade_is_running(uint8_t id) FADE_BANKED_FN;
+void fade_update(void) FADE_BANKED_FN;
+
+#endif
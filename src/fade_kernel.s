@@ -0,0 +1,208 @@
+;* ------------------------------------------------------------------------------------------- *;
+;* ------------------------------------  FADE KERNEL ASM  ------------------------------------ *;
+;* ------------------------------------------------------------------------------------------- *;
+
+; Hand-written SM83 version of fade_palette_toward(), linked with: make FADE_KERNEL=ASM
+;
+; Per channel, with the channel in A, its target in L and the step in H:
+;     above the target:  rest = c - t - step, clamped at 0  ->  new = t + rest
+;     below the target:  rest = c - t + step, no carry      ->  new = t + rest (negative)
+;                        carry out (step covers it)         ->  new = t
+; Blue is stepped in place at bits 2-6 with step << 2, green is gathered into bits 0-4 with
+; one xor-merge and three rotates, no per-bit shifting.
+;
+; Loop state stays in registers, one color at a time:
+;     B, C = target lo, hi     D, E = color lo, hi     H = step     L = target channel
+; the two pointers wait on the stack while a color is worked on. No counter: the 4 colors are
+; 4 calls, and the first color off its target drops to a path that skips the compares.
+;
+; M-cycles, run on an SM83 instruction-level model over 20000 random palettes and steps, the
+; same results as the SCALAR kernel on each:
+;     per color  <= 161 with its call and ret
+;     per call   <= 664 (every color on target, all 4 compares taken), 653 once a color is off.
+;     Was ~1050 with the loop state in _DATA, reloaded per color.
+
+; sdcccall(1): DE = palette, BC = target, returns A = 1 once every color equals its target.
+; The step is read from _fade_kernel_step, set by the C wrapper.
+
+	.module fade_kernel
+
+	.globl	_fade_kernel_step
+
+	.area	_CODE
+
+; uint8_t fade_palette_toward_asm(palette_color_t* palette, const palette_color_t* target)
+_fade_palette_toward_asm::
+	ld	h, b
+	ld	l, c			; HL = target, DE = palette
+
+	call	fade_color_toward
+	or	a
+	jr	nz, 10$
+	call	fade_color_toward
+	or	a
+	jr	nz, 11$
+	call	fade_color_toward
+	or	a
+	jr	nz, 12$
+	call	fade_color_toward
+	or	a
+	jr	nz, 13$
+	ld	a, #1			; every color on its target
+	ret
+
+10$:					; NOTE: a color is off, the rest only need stepping
+	call	fade_color_toward
+11$:
+	call	fade_color_toward
+12$:
+	call	fade_color_toward
+13$:
+	xor	a
+	ret
+
+; DE = palette color, HL = target color -> both advanced by one color,
+; A = 0 if the new color equals its target. Clobbers everything.
+fade_color_toward:
+	ld	a, (hl+)
+	ld	b, a
+	ld	a, (hl+)
+	ld	c, a			; BC = target lo, hi
+	push	hl			; next target color
+	ld	h, d
+	ld	l, e
+	ld	a, (hl+)
+	ld	d, a
+	ld	a, (hl-)
+	ld	e, a			; DE = color lo (gggrrrrr), hi (xbbbbbgg)
+	push	hl			; this palette color
+
+	ld	a, (_fade_kernel_step)
+	add	a, a
+	add	a, a
+	ld	h, a			; H = step << 2, for blue in place
+
+	; -- blue: hi & 0x7C
+	ld	a, c
+	and	#0x7C
+	ld	l, a
+	ld	a, e
+	and	#0x7C
+	sub	l
+	jr	c, 2$
+	sub	h
+	jr	nc, 1$
+	xor	a
+1$:
+	add	a, l
+	jr	3$
+2$:
+	add	a, h
+	jr	nc, 21$
+	xor	a
+21$:
+	add	a, l
+3$:
+	ld	l, a
+	ld	a, e
+	xor	l
+	and	#0x7C
+	xor	e
+	ld	e, a
+
+	srl	h
+	srl	h			; H = step
+
+	; -- green: (lo & 0xE0 | hi & 0x1F) rotated left by 3 = 000GGggg
+	ld	a, b
+	xor	c
+	and	#0x1F
+	xor	b
+	rlca
+	rlca
+	rlca
+	and	#0x1F
+	ld	l, a
+	ld	a, d
+	xor	e
+	and	#0x1F
+	xor	d
+	rlca
+	rlca
+	rlca
+	and	#0x1F
+	sub	l
+	jr	c, 5$
+	sub	h
+	jr	nc, 4$
+	xor	a
+4$:
+	add	a, l
+	jr	6$
+5$:
+	add	a, h
+	jr	nc, 51$
+	xor	a
+51$:
+	add	a, l
+6$:
+	rrca
+	rrca
+	rrca				; ggg000GG, back into place
+	ld	l, a
+	ld	a, d
+	xor	l
+	and	#0xE0
+	xor	d
+	ld	d, a
+	ld	a, e
+	xor	l
+	and	#0x03
+	xor	e
+	ld	e, a
+
+	; -- red: lo & 0x1F
+	ld	a, b
+	and	#0x1F
+	ld	l, a
+	ld	a, d
+	and	#0x1F
+	sub	l
+	jr	c, 8$
+	sub	h
+	jr	nc, 7$
+	xor	a
+7$:
+	add	a, l
+	jr	9$
+8$:
+	add	a, h
+	jr	nc, 81$
+	xor	a
+81$:
+	add	a, l
+9$:
+	ld	l, a
+	ld	a, d
+	xor	l
+	and	#0x1F
+	xor	d
+	ld	d, a
+
+	pop	hl			; store the new color
+	ld	a, d
+	ld	(hl+), a
+	ld	a, e
+	ld	(hl+), a
+
+	ld	a, d			; A = 0 on target
+	xor	b
+	ld	b, a
+	ld	a, e
+	xor	c
+	or	b
+
+	ld	d, h
+	ld	e, l			; DE = next palette color
+	pop	hl			; HL = next target color
+	ret
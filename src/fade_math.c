@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include <stdbool.h> // bool, true, false
+
+#include "fade_math.h"
+
+#if FADE_KERNEL == FADE_KERNEL_ASM && !defined(__SDCC)
+#error "FADE_KERNEL_ASM is SM83 only, host builds take SCALAR or SWAR"
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ----------------------------------------  KERNELS  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Every fade moves each 5-bit channel towards its target by a per-frame step, clamped to the target.
+	The steps of one fade always add up to FADE_DISTANCE, so every channel arrives by the last frame,
+	and palettes with small distances converge (and drop out) early.
+
+	The per-frame step comes from a DDA over the fade duration: whole + fraction, the fraction
+	accumulated in an error-term. Division only happens once in fade_pace_init(), none per frame.
+
+	Three kernels, same results, picked with FADE_KERNEL (see Makefile):
+		- SCALAR: unpacks the channels, clamps with compare-branches. Reference version.
+		- SWAR: works on the packed RGB555 word, R+B in one pass and G in another. A guard bit
+		  above every field catches the borrow of a subtract, and turns into a 5-bit field mask,
+		  no branches and no unpacking.
+		- ASM: hand-written SM83 in fade_kernel.s. Each channel is masked in place in its byte,
+		  the carry flag of one subtract picks the direction, and the whole color stays in
+		  registers.
+
+	Cost per 4-color palette, M-cycles:
+		- fixed-step clamp, unpack + 3 clamps + RGB() repack: ~520 to black / white, ~800 from
+		  black / white (hand-counted estimate, --opt-code-speed).
+		- fixed-step ROM table fade_toward_LUT[target][current]: ~240 and ~320 (same estimate).
+		  Dropped once the step became per-frame (DDA above): one 1KB table per step.
+		- ASM: <= 664, run on an SM83 instruction-level model (see fade_kernel.s). Was ~1050 with
+		  its loop state in _DATA.
+		- SCALAR, SWAR: not measured, they depend on SDCC's codegen. Read them off the .asm
+		  listing of a build, or time fade_palette_toward() with the FADE_PROFILE scanline counters.
+*/
+
+#if FADE_KERNEL == FADE_KERNEL_SCALAR
+
+static inline uint8_t fade_channel_toward(uint8_t channel, uint8_t target, uint8_t step) { // move by step, clamped to target
+
+	if (channel < target) return (target - channel > step) ? channel + step : target;
+	if (channel > target) return (channel - target > step) ? channel - step : target;
+	return target;
+
+}
+
+static inline uint16_t fade_color_toward(uint16_t color, uint16_t target, uint8_t step) {
+
+	uint8_t lo = (uint8_t)color; // RGB555 bytes: lo = gggrrrrr, hi = xbbbbbgg (byte-shifts only, no 16-bit shifts)
+	uint8_t hi = (uint8_t)(color >> 8);
+	uint8_t target_lo = (uint8_t)target;
+	uint8_t target_hi = (uint8_t)(target >> 8);
+
+	uint8_t r = fade_channel_toward(lo & 0x1F, target_lo & 0x1F, step);
+	uint8_t g = fade_channel_toward(((lo >> 5) | (hi << 3)) & 0x1F, ((target_lo >> 5) | (target_hi << 3)) & 0x1F, step);
+	uint8_t b = fade_channel_toward((hi >> 2) & 0x1F, (target_hi >> 2) & 0x1F, step);
+
+	lo = r | (g << 5); // repack
+	hi = (g >> 3) | (b << 2);
+
+	return ((uint16_t)hi << 8) | lo;
+
+}
+
+bool fade_palette_toward(uint16_t* palette, const uint16_t* target, uint8_t step) { // returns true once every color reached its target
+
+	bool converged = true;
+
+	for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+		palette[i] = fade_color_toward(palette[i], target[i], step);
+		if (palette[i] != target[i]) converged = false;
+	}
+
+	return converged;
+
+}
+
+#elif FADE_KERNEL == FADE_KERNEL_SWAR
+
+#define SWAR_FIELDS_RB 0x7C1F // red and blue of RGB555, with a spare bit above each
+#define SWAR_GUARDS_RB 0x8020
+#define SWAR_FIELDS_G 0x03E0 // green on its own pass, the lowest blue bit is free to be its guard
+#define SWAR_GUARDS_G 0x0400
+
+#define SWAR_GUARDS_TO_FIELDS(guards) ((guards) - ((guards) >> 5)) // every surviving guard bit into a 0x1F mask of its field
+
+static inline uint16_t fade_fields_toward(uint16_t color, uint16_t target, uint16_t step, uint16_t fields, uint16_t guards) { // step replicated into every field
+
+	color &= fields;
+	target &= fields;
+
+	uint16_t diff = (color | guards) - target; // per field: guard survives where color >= target
+	uint16_t above = SWAR_GUARDS_TO_FIELDS(diff & guards);
+	uint16_t distance = (diff & above) | (((target | guards) - color) & ~above & fields); // per field |color - target|
+
+	uint16_t rest = (distance | guards) - step; // per field: distance left after this step, guard survives where distance >= step
+	rest &= SWAR_GUARDS_TO_FIELDS(rest & guards); // saturate at 0
+
+	return (target + (rest & above)) - (rest & ~above); // back off the target by the rest, on the side the color came from
+
+}
+
+bool fade_palette_toward(uint16_t* palette, const uint16_t* target, uint8_t step) { // returns true once every color reached its target
+
+	bool converged = true;
+
+	uint16_t step_rb = ((uint16_t)(uint8_t)(step << 2) << 8) | step; // step in red and blue field
+	uint16_t step_g = ((uint16_t)(step >> 3) << 8) | (uint8_t)(step << 5); // step in green field
+
+	for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+		palette[i] = fade_fields_toward(palette[i], target[i], step_rb, SWAR_FIELDS_RB, SWAR_GUARDS_RB)
+			| fade_fields_toward(palette[i], target[i], step_g, SWAR_FIELDS_G, SWAR_GUARDS_G);
+		if (palette[i] != target[i]) converged = false;
+	}
+
+	return converged;
+
+}
+
+#elif FADE_KERNEL == FADE_KERNEL_ASM
+
+uint8_t fade_kernel_step; // step operand of fade_palette_toward_asm(), fade_kernel.s
+
+uint8_t fade_palette_toward_asm(uint16_t* palette, const uint16_t* target);
+
+bool fade_palette_toward(uint16_t* palette, const uint16_t* target, uint8_t step) { // returns true once every color reached its target
+
+	fade_kernel_step = step;
+	return fade_palette_toward_asm(palette, target);
+
+}
+
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  PACE  ------------------------------------------ *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void fade_pace_init(fade_pace_t* pace, uint8_t frames) { // the only division of a fade
+
+	if (frames == 0) frames = 1;
+
+	pace->frames = frames;
+	pace->step_whole = FADE_DISTANCE / frames;
+	pace->step_fraction = FADE_DISTANCE % frames;
+	pace->step_error = 0;
+
+}
+
+uint8_t fade_pace_step(fade_pace_t* pace) { // step of the next frame, 0 on the frames without movement
+
+	uint8_t step = pace->step_whole;
+
+	pace->step_error += pace->step_fraction;
+	if (pace->step_error >= pace->frames) {
+		pace->step_error -= pace->frames;
+		step++;
+	}
+
+	return step;
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  TRANSFORMS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+// NOTE: luma = 0.299 r + 0.587 g + 0.114 b, each channel pre-weighted, rounded so white sums to 31
+
+static const uint8_t luma_red[FADE_RAMP_SIZE] = {
+	0, 0, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5,
+	5, 5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 8, 9, 9, 9
+};
+
+static const uint8_t luma_green[FADE_RAMP_SIZE] = {
+	0, 1, 1, 2, 2, 3, 4, 4, 5, 5, 6, 6, 7, 8, 8, 9,
+	9, 10, 11, 11, 12, 12, 13, 13, 14, 15, 15, 16, 16, 17, 18, 18
+};
+
+static const uint8_t luma_blue[FADE_RAMP_SIZE] = {
+	0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2,
+	2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 4
+};
+
+const uint16_t fade_ramp_grey[FADE_RAMP_SIZE] = {
+	FADE_RGB(0, 0, 0), FADE_RGB(1, 1, 1), FADE_RGB(2, 2, 2), FADE_RGB(3, 3, 3),
+	FADE_RGB(4, 4, 4), FADE_RGB(5, 5, 5), FADE_RGB(6, 6, 6), FADE_RGB(7, 7, 7),
+	FADE_RGB(8, 8, 8), FADE_RGB(9, 9, 9), FADE_RGB(10, 10, 10), FADE_RGB(11, 11, 11),
+	FADE_RGB(12, 12, 12), FADE_RGB(13, 13, 13), FADE_RGB(14, 14, 14), FADE_RGB(15, 15, 15),
+	FADE_RGB(16, 16, 16), FADE_RGB(17, 17, 17), FADE_RGB(18, 18, 18), FADE_RGB(19, 19, 19),
+	FADE_RGB(20, 20, 20), FADE_RGB(21, 21, 21), FADE_RGB(22, 22, 22), FADE_RGB(23, 23, 23),
+	FADE_RGB(24, 24, 24), FADE_RGB(25, 25, 25), FADE_RGB(26, 26, 26), FADE_RGB(27, 27, 27),
+	FADE_RGB(28, 28, 28), FADE_RGB(29, 29, 29), FADE_RGB(30, 30, 30), FADE_RGB(31, 31, 31)
+};
+
+const uint16_t fade_ramp_sepia[FADE_RAMP_SIZE] = { // warm, blue fades out first
+	FADE_RGB(0, 0, 0), FADE_RGB(1, 1, 1), FADE_RGB(2, 2, 1), FADE_RGB(3, 2, 2),
+	FADE_RGB(4, 3, 2), FADE_RGB(5, 4, 3), FADE_RGB(6, 5, 3), FADE_RGB(7, 6, 4),
+	FADE_RGB(8, 6, 4), FADE_RGB(9, 7, 5), FADE_RGB(10, 8, 6), FADE_RGB(11, 9, 6),
+	FADE_RGB(12, 10, 7), FADE_RGB(13, 10, 7), FADE_RGB(14, 11, 8), FADE_RGB(15, 12, 8),
+	FADE_RGB(16, 13, 9), FADE_RGB(17, 14, 9), FADE_RGB(18, 14, 10), FADE_RGB(19, 15, 10),
+	FADE_RGB(20, 16, 11), FADE_RGB(21, 17, 12), FADE_RGB(22, 18, 12), FADE_RGB(23, 18, 13),
+	FADE_RGB(24, 19, 13), FADE_RGB(25, 20, 14), FADE_RGB(26, 21, 14), FADE_RGB(27, 22, 15),
+	FADE_RGB(28, 22, 15), FADE_RGB(29, 23, 16), FADE_RGB(30, 24, 16), FADE_RGB(31, 25, 17)
+};
+
+const uint16_t fade_ramp_red[FADE_RAMP_SIZE] = { // damage flash, never darker than a dim red
+	FADE_RGB(12, 0, 0), FADE_RGB(13, 0, 0), FADE_RGB(13, 0, 0), FADE_RGB(14, 1, 1),
+	FADE_RGB(14, 1, 1), FADE_RGB(15, 1, 1), FADE_RGB(16, 2, 2), FADE_RGB(16, 2, 2),
+	FADE_RGB(17, 2, 2), FADE_RGB(18, 3, 3), FADE_RGB(18, 3, 3), FADE_RGB(19, 3, 3),
+	FADE_RGB(19, 4, 4), FADE_RGB(20, 4, 4), FADE_RGB(21, 4, 4), FADE_RGB(21, 5, 5),
+	FADE_RGB(22, 5, 5), FADE_RGB(22, 5, 5), FADE_RGB(23, 6, 6), FADE_RGB(24, 6, 6),
+	FADE_RGB(24, 6, 6), FADE_RGB(25, 7, 7), FADE_RGB(25, 7, 7), FADE_RGB(26, 7, 7),
+	FADE_RGB(27, 8, 8), FADE_RGB(27, 8, 8), FADE_RGB(28, 8, 8), FADE_RGB(29, 9, 9),
+	FADE_RGB(29, 9, 9), FADE_RGB(30, 9, 9), FADE_RGB(30, 10, 10), FADE_RGB(31, 10, 10)
+};
+
+uint8_t fade_color_luma(uint16_t color) { // 0-31, three lookups, no multiplies
+
+	return luma_red[color & 0x1F] + luma_green[(color >> 5) & 0x1F] + luma_blue[(color >> 10) & 0x1F];
+
+}
+
+void fade_palette_map(uint16_t* out, const uint16_t* palette, const uint16_t* ramp) { // every color to ramp[luma], greyscale/sepia/tint targets
+
+	for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+		out[i] = ramp[fade_color_luma(palette[i])];
+	}
+
+}
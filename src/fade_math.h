@@ -0,0 +1,64 @@
+#ifndef FADE_MATH_H
+#define FADE_MATH_H
+
+#include <stdint.h>
+#include <stdbool.h> // bool, true, false
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Pure palette math of the fade engine: no GBDK headers, no hardware, no globals.
+	Compiles for the ROM (sdcc) and the host (gcc), see `make test` / `make bench`.
+
+	Colors are RGB555 words, the layout of palette_color_t: 0bbbbbgggggrrrrr.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  FADE MACROS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define PALETTE_SIZE 4 // palette has 4 rgb colors
+
+#define FADE_DISTANCE 31 // total step of every fade, max distance of a 5-bit channel
+
+#define FADE_KERNEL_SCALAR 1 // fade-step kernel, picked at build time: make FADE_KERNEL=SCALAR|SWAR|ASM
+#define FADE_KERNEL_SWAR 2
+#define FADE_KERNEL_ASM 3
+
+#ifndef FADE_KERNEL
+#define FADE_KERNEL FADE_KERNEL_SWAR
+#endif
+
+#define FADE_RAMP_SIZE 32 // luma ramps: one color per 5-bit luma
+#define FADE_RGB(r, g, b) ((uint16_t)((r) | ((g) << 5) | ((b) << 10))) // RGB555, same as GBDK RGB(), host-safe
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+typedef struct { // DDA pace of one fade, steps add up to FADE_DISTANCE over frames
+	uint8_t frames;
+	uint8_t step_whole; // FADE_DISTANCE / frames, per frame
+	uint8_t step_fraction; // FADE_DISTANCE % frames, accumulated into step_error
+	uint16_t step_error;
+} fade_pace_t;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+bool fade_palette_toward(uint16_t* palette, const uint16_t* target, uint8_t step);
+
+void fade_pace_init(fade_pace_t* pace, uint8_t frames);
+uint8_t fade_pace_step(fade_pace_t* pace);
+
+extern const uint16_t fade_ramp_grey[FADE_RAMP_SIZE]; // luma ramps for fade_palette_map()
+extern const uint16_t fade_ramp_sepia[FADE_RAMP_SIZE];
+extern const uint16_t fade_ramp_red[FADE_RAMP_SIZE];
+
+uint8_t fade_color_luma(uint16_t color);
+void fade_palette_map(uint16_t* out, const uint16_t* palette, const uint16_t* ramp);
+
+#endif
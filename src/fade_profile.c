@@ -0,0 +1,173 @@
+#include <gb/gb.h>
+
+#include <gbdk/emu_debug.h> // EMU_printf()
+
+#include "fade_profile.h"
+
+#ifdef FADE_PROFILE
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define LINES_PER_FRAME 154 // 144 drawn + 10 VBlank
+#define LINE_VBLANK 144 // first VBlank line, sys_time ticks here
+
+#define CYCLES_PER_FRAME 17556UL // M-cycles at single speed, twice that at double
+#define CYCLES_PER_TICK 256UL // TIMA at 4096 Hz at single speed, the same M-cycles at double
+
+profile_phase_t profile_phases[PROFILE_PHASES];
+
+const char* const profile_phase_names[PROFILE_PHASES] = { "CMP", "CPY", "STG", "UPL" };
+
+uint16_t profile_startup_frames;
+volatile uint16_t profile_startup_overflows;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static uint8_t sample_line(uint16_t* frame) { // LY as lines since the last VBlank, with the matching sys_time
+
+	uint8_t ly;
+
+	do { // NOTE: retry if the VBL handler ticked sys_time in between
+		*frame = sys_time;
+		ly = LY_REG;
+	} while (*frame != sys_time);
+
+	return (ly >= LINE_VBLANK) ? ly - LINE_VBLANK : ly + (LINES_PER_FRAME - LINE_VBLANK);
+
+}
+
+void profile_begin(uint8_t phase) {
+
+	profile_phase_t* p = &profile_phases[phase];
+
+	p->start_div = DIV_REG;
+	p->start_ly = sample_line(&p->start_frame);
+
+}
+
+void profile_end(uint8_t phase) {
+
+	uint16_t frame;
+	uint8_t line = sample_line(&frame);
+	uint8_t div = DIV_REG - profile_phases[phase].start_div;
+
+	profile_phase_t* p = &profile_phases[phase];
+
+	uint16_t frames = frame - p->start_frame;
+	uint16_t lines = (frames * LINES_PER_FRAME) + line - p->start_ly;
+
+	if (p->samples == 0 || lines < p->lines_min) p->lines_min = lines;
+	if (lines > p->lines_max) p->lines_max = lines;
+	if (p->samples == 0 || div < p->div_min) p->div_min = div;
+	if (div > p->div_max) p->div_max = div;
+
+	p->lines_total += lines;
+	p->div_total += div;
+	p->samples++;
+
+	if (phase == PROFILE_UPLOAD) {
+		if (LY_REG < LINE_VBLANK) p->overruns++; // NOTE: palette RAM written while drawing
+	} else {
+		if (frames != 0) p->overruns++; // NOTE: ran across a VBlank
+	}
+
+}
+
+void profile_reset(void) { // NOTE: the VBL handler adds UPLOAD samples, no half-cleared phase for it
+
+	CRITICAL {
+		for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+			profile_phases[i].samples = 0;
+			profile_phases[i].lines_min = 0;
+			profile_phases[i].lines_max = 0;
+			profile_phases[i].lines_total = 0;
+			profile_phases[i].div_min = 0;
+			profile_phases[i].div_max = 0;
+			profile_phases[i].div_total = 0;
+			profile_phases[i].overruns = 0;
+		}
+	}
+
+}
+
+uint16_t profile_lines_avg(uint8_t phase) {
+
+	if (profile_phases[phase].samples == 0) return 0;
+	return profile_phases[phase].lines_total / profile_phases[phase].samples;
+
+}
+
+void profile_report(void) { // one line per phase, for the emulator debug console
+
+	for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+		profile_phase_t* p = &profile_phases[i];
+
+		if (p->samples == 0) continue;
+
+		EMU_printf("FADE %s n:%u lines %u/%u/%u div %u/%u/%u overruns:%u",
+			profile_phase_names[i], p->samples,
+			p->lines_min, p->lines_max, profile_lines_avg(i),
+			(uint16_t)p->div_min, (uint16_t)p->div_max, p->div_total / p->samples,
+			(uint16_t)p->overruns);
+	}
+
+}
+
+//+ ------------------------------  STARTUP  ------------------------------ +//
+
+static void profile_startup_tick(void) {
+
+	profile_startup_overflows++;
+
+}
+
+void profile_startup_begin(void) { // NOTE: startup stays at one speed, profile_startup_end() reads it from KEY1
+
+	profile_startup_overflows = 0;
+
+	CRITICAL {
+		TMA_REG = 0;
+		TIMA_REG = 0;
+		IF_REG &= ~TIM_IFLAG; // NOTE: no stale overflow from before the start
+		TAC_REG = TACF_START | TACF_4KHZ;
+
+		add_TIM(profile_startup_tick);
+	}
+
+	set_interrupts(IE_REG | TIM_IFLAG);
+
+}
+
+void profile_startup_end(void) { // right after the display enable
+
+	uint16_t overflows;
+	uint8_t tima;
+
+	CRITICAL {
+		overflows = profile_startup_overflows;
+		tima = TIMA_REG;
+		if (IF_REG & TIM_IFLAG) { // NOTE: overflowed, not serviced yet
+			overflows++;
+			tima = TIMA_REG;
+		}
+
+		TAC_REG = 0;
+		IF_REG &= ~TIM_IFLAG; // NOTE: counted above, dont leave it pending for whoever enables TIM next
+		remove_TIM(profile_startup_tick);
+	}
+
+	set_interrupts(IE_REG & ~TIM_IFLAG);
+
+	uint32_t ticks = ((uint32_t)overflows << 8) | tima;
+	uint32_t cycles_per_frame = (KEY1_REG & 0x80) ? CYCLES_PER_FRAME * 2 : CYCLES_PER_FRAME;
+	profile_startup_frames = (uint16_t)((ticks * (CYCLES_PER_TICK * 100) + (cycles_per_frame / 2)) / cycles_per_frame);
+
+	EMU_printf("STARTUP %u.%u%u frames", profile_startup_frames / 100, (profile_startup_frames / 10) % 10, profile_startup_frames % 10);
+
+}
+
+#endif
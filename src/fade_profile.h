@@ -0,0 +1,103 @@
+#ifndef FADE_PROFILE_H
+#define FADE_PROFILE_H
+
+#include <gb/gb.h>
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Opt-in profiling of the fade engine: make FADE_PROFILE=1
+	Without it, every PROFILE_* macro is empty and nothing here is linked.
+
+	Each phase samples LY_REG, DIV_REG and sys_time on begin and end:
+		- lines: scanlines spent, across frames (sys_time), exact to one line.
+		- div: DIV ticks spent (64 M-cycles each, at either cpu speed), finer than
+		  a line but wraps after 256, only meaningful for phases shorter than a frame.
+		- overruns: the upload left VBlank (palette writes during drawing), or a main-loop
+		  phase ran across a VBlank (its frame was missed).
+
+	Stats restart with every fade and are sent to EMU_printf() once it finishes,
+	the demo also shows them on screen: hold SELECT, press START.
+	The begin/end calls are part of every sample, a few dozen M-cycles, well under a scanline.
+
+	Startup (init_system() to the display enable, the wait for VBlank before the LCD goes off
+	included) is timed apart: the LCD is off, so neither LY nor sys_time move. The timer counts
+	it, TIMA at 4096 Hz with an overflow interrupt, sent to EMU_printf() in hundredths of a frame.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ------------------------------------  PROFILE MACROS  ------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define PROFILE_COMPUTE 0 // kernel over the active palettes, fade_step_gbc()
+#define PROFILE_COPY 1 // const palettes copied to the WRAM back-buffer, fade_palettes() / track_palette()
+#define PROFILE_STAGE 2 // back- to front-buffer, stage_palettes()
+#define PROFILE_UPLOAD 3 // front-buffer to palette RAM, palette_vbl_isr()
+#define PROFILE_PHASES 4
+
+#ifdef FADE_PROFILE
+
+#define PROFILE_BEGIN(phase) profile_begin(phase)
+#define PROFILE_END(phase) profile_end(phase)
+#define PROFILE_RESET() profile_reset()
+#define PROFILE_REPORT() profile_report()
+#define PROFILE_STARTUP_BEGIN() profile_startup_begin()
+#define PROFILE_STARTUP_END() profile_startup_end()
+
+#else
+
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_RESET()
+#define PROFILE_REPORT()
+#define PROFILE_STARTUP_BEGIN()
+#define PROFILE_STARTUP_END()
+
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#ifdef FADE_PROFILE
+
+typedef struct {
+	uint16_t start_frame; // sys_time, LY_REG and DIV_REG on begin
+	uint8_t start_ly;
+	uint8_t start_div;
+
+	uint16_t samples;
+	uint16_t lines_min;
+	uint16_t lines_max;
+	uint16_t lines_total;
+	uint8_t div_min;
+	uint8_t div_max;
+	uint16_t div_total;
+	uint8_t overruns;
+} profile_phase_t;
+
+extern profile_phase_t profile_phases[PROFILE_PHASES];
+extern const char* const profile_phase_names[PROFILE_PHASES];
+
+extern uint16_t profile_startup_frames; // hundredths of a frame, boot to the display enable
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void profile_begin(uint8_t phase);
+void profile_end(uint8_t phase);
+
+void profile_reset(void);
+void profile_report(void);
+
+uint16_t profile_lines_avg(uint8_t phase);
+
+void profile_startup_begin(void);
+void profile_startup_end(void);
+
+#endif
+
+#endif
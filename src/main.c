@@ -5,10 +5,18 @@
 #include <gbdk/console.h> // gotoxy()
 
 #include <stdbool.h> // bool, true, false
-#include <string.h> // memcpy
+#include <string.h> // memcpy, memset
 #include <stdio.h> // printf()
 #include <rand.h> // initarand(), arand()
 
+#include "fade.h"
+#include "fade_profile.h" // make FADE_PROFILE=1
+#include "raster.h" // raster_init()
+#include "vram.h" // vram_copy_now(), vram_update()
+#include "attr.h" // attr_set_palette(), attr_set_sprite_palette()
+#include "speed.h" // speed_update()
+#include "palettes.h" // generated: palette_reds..., palette_ladders
+
 //* ------------------------------------------------------------------------------------------- *//
 //* -----------------------------------------  NOTES  ----------------------------------------- *//
 //* ------------------------------------------------------------------------------------------- *//
@@ -16,8 +24,8 @@
 /*
 	This is an attempt to do a reusable fade-effect for GBC.
 
-	Its not performant (actually its pretty expensive), and should probably use `cpu_fast()` if you are using a lot of palettes.
-	Definitely should be banked, as it takes A LOT of legwork and code to get there.
+	Its not performant (actually its pretty expensive), so fades on a lot of palettes switch to double speed while they run (src/speed.c).
+	It takes A LOT of legwork and code to get there, `make MBC=5` moves it out of bank 0 (src/fade.h).
 
 	However, I did try to make it agnostic of what palettes are used where, and how many.
 	So it hopefully its less management during game-logic, and can be just used as a util.
@@ -25,7 +33,7 @@
 	The basic premise is:
 		- keep a lookup-table when you set palettes, to track which are used where.
 		- memcpy the currently used const palettes to WRAM, so they can be adjusted.
-		- fade the WRAM. load the WRAM. repeat until finished.
+		- fade the WRAM. stage the WRAM, loaded by the VBL handler. one step per `fade_update()` tick, until finished.
 	
 															- Anchor
 */
@@ -45,23 +53,13 @@
 
 //+ --  PALETTES  -- +//
 
-#define MAX_HARDWARE_PALETTES 8 // 8 palettes for sprites, 8 palettes for bkg
-
-#define PALETTE_NULL_FLAG 0xFF // for palette_bkg_to_edit, when current_bkg_palettes[idx] is NULL
-
-#define PALETTE_SIZE 4 // palette has 4 rgb colors
-#define PALETTE_BYTES (PALETTE_SIZE * sizeof(uint16_t)) // total bytes of one palette
-
 #define BKG_PALMASK 0x07 // mask for palette bits (bits 0-2)
 
-//* ------------------------------------------------------------------------------------------- *//
-//* --------------------------------------  GAME MACROS  -------------------------------------- *//
-//* ------------------------------------------------------------------------------------------- *//
-
-//+ --  PALETTES  -- +//
+//+ --  VRAM  -- +//
 
-#define FADE_STEP_GBC 4
-#define FADE_STEP_COUNTER_GBC 8 // 8 * 4 = 32
+#define VRAM_CLEAR_TILES 128 // sprite tiles 0-127, shared with bkg tiles 0-127
+#define VRAM_TILE_BYTES 16
+#define VRAM_MAP_BYTES (32 * 32)
 
 //* ------------------------------------------------------------------------------------------- *//
 //* --------------------------------------  DEFINITIONS  -------------------------------------- *//
@@ -70,7 +68,6 @@
 //+ ------------------------------  SYSTEM  ------------------------------- +//
 
 bool is_gbc;
-// bool is_cpu_fast;
 
 //+ -------------------------------  FONT  -------------------------------- +//
 
@@ -81,35 +78,14 @@ font_t font;
 bool is_faded = FALSE;
 bool to_black = TRUE;
 
-const palette_color_t* current_bkg_palettes_LUT[MAX_HARDWARE_PALETTES]; // pointers, hardware-palette-index to currently used const palette
-const palette_color_t* current_sprite_palettes_LUT[MAX_HARDWARE_PALETTES];
-
-// palette_color_t palette_bkg_to_edit_0[PALETTE_SIZE]; // not fading palette-0, to keep the background text
-palette_color_t palette_bkg_to_edit_1[PALETTE_SIZE]; // memcpy currently used const palettes to WRAM to edit values
-palette_color_t palette_bkg_to_edit_2[PALETTE_SIZE];
-palette_color_t palette_bkg_to_edit_3[PALETTE_SIZE];
-palette_color_t palette_bkg_to_edit_4[PALETTE_SIZE];
-palette_color_t palette_bkg_to_edit_5[PALETTE_SIZE];
-palette_color_t palette_bkg_to_edit_6[PALETTE_SIZE];
-palette_color_t palette_bkg_to_edit_7[PALETTE_SIZE];
-
-// palette_color_t palette_sprite_to_edit_0[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_1[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_2[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_3[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_4[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_5[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_6[PALETTE_SIZE];
-palette_color_t palette_sprite_to_edit_7[PALETTE_SIZE];
+#ifdef FADE_PROFILE
+bool is_profile_overlay = FALSE; // SELECT + START, replaces the controls text
+#endif
 
 //* ------------------------------------------------------------------------------------------- *//
 //* ----------------------------------------  ASSETS  ----------------------------------------- *//
 //* ------------------------------------------------------------------------------------------- *//
 
-const unsigned char white_tile[] = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
-
 const unsigned char basic_tiles[] = {
 	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // white
 	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
@@ -128,61 +104,7 @@ const unsigned char basic_tiles[] = {
 //* ---------------------------------------  PALLETES  ---------------------------------------- *//
 //* ------------------------------------------------------------------------------------------- *//
 
-const palette_color_t palette_all_black[] = {
-	RGB(0, 0, 0),
-	RGB(0, 0, 0),
-	RGB(0, 0, 0),
-	RGB(0, 0, 0)
-};
-
-const palette_color_t palette_all_white[] = {
-	RGB(31, 31, 31),
-	RGB(31, 31, 31),
-	RGB(31, 31, 31),
-	RGB(31, 31, 31)
-};
-
-const palette_color_t palette_reds[] = { // 4 shades of red
-	RGB(31, 21, 21),
-	RGB(31, 14, 14),
-	RGB(31, 7, 7),
-	RGB(31, 0, 0)
-};
-
-const palette_color_t palette_greens[] = { // 4 shades of green
-	RGB(21, 31, 21),
-	RGB(14, 31, 14),
-	RGB(7, 31, 7),
-	RGB(0, 31, 0)
-};
-
-const palette_color_t palette_blues[] = { // 4 shades of blue
-	RGB(21, 21, 31),
-	RGB(14, 14, 31),
-	RGB(7, 7, 31),
-	RGB(0, 0, 31)
-};
-
-const palette_color_t palette_oranges[] = { // 4 shades of orange
-	RGB(31, 31, 24),
-	RGB(31, 28, 16),
-	RGB(31, 25, 8),
-	RGB(31, 22, 0)
-};
-
-const palette_color_t palette_cyans[] = { // 4 shades of cyan
-	RGB(21, 31, 31),
-	RGB(14, 31, 28),
-	RGB(7, 31, 25),
-	RGB(0, 31, 22)
-};
-
-const palette_color_t palette_purples[] = { // 4 shades of purple
-	RGB(30, 24, 30),
-	RGB(28, 16, 28),
-	RGB(23, 8, 23),
-	RGB(21, 0, 21)
-};
+// NOTE: compiled from assets/palettes.pal by tools/palc.c, see palettes.h
 
 //* ------------------------------------------------------------------------------------------- *//
 //* ------------------------------------------  SFX  ------------------------------------------ *//
@@ -233,35 +155,44 @@ void set_cpu(void) {
 	CRITICAL {
 		if (_cpu == CGB_TYPE) is_gbc = TRUE;
 		if (is_gbc) {
-			cpu_fast();
-			// is_cpu_fast = TRUE;
-
 			set_default_palette(); // palette-0, grayscale
 		}
 	}
 
 }
 
-void clear_sprite_tiles(void) {
+void clear_vram(void) { // NOTE: LCD off only, plain memsets with no STAT waits
+
+	memset(_VRAM8000, 0x00, VRAM_CLEAR_TILES * VRAM_TILE_BYTES); // white tiles
+	memset(_SCRN0, 0x00, VRAM_MAP_BYTES); // bkg_map with tile-0
 
-	for (uint8_t i = 0; i < 127; i++) {
-		set_sprite_data(i, 1, white_tile);
+	if (is_gbc) {
+		VBK_REG = VBK_ATTRIBUTES;
+		memset(_SCRN0, 0x00, VRAM_MAP_BYTES); // attributes: palette-0, bank-0, no flips
+		VBK_REG = VBK_TILES;
 	}
 
 }
 
 void init_system(void) {
 
+	PROFILE_STARTUP_BEGIN(); // NOTE: before DISPLAY_OFF, its wait for VBlank is part of startup
+	DISPLAY_OFF; // NOTE: until init_game() is done, VRAM is open in every mode
+
 	set_cpu();
+	speed_init(); // NOTE: single speed, fades ask for double
+
+	fade_init(); // NOTE: subengine - registers the palette VBL handler
+	raster_init(); // NOTE: idle until a table is submitted, LYC never matches
+	vram_init();
 
-	clear_sprite_tiles(); // clear VRAM
-	init_bkg(0); // reset bkg_map with tile-0
+	clear_vram();
+	attr_init(); // NOTE: shadow matches the cleared attribute map
 
 	SHOW_BKG;
 	SHOW_SPRITES;
 
 	SOUND_ON;
-	DISPLAY_ON;
 
 }
 
@@ -269,54 +200,42 @@ void init_system(void) {
 //* -----------------------------------------  INITS  ----------------------------------------- *//
 //* ------------------------------------------------------------------------------------------- *//
 
-void clear_current_bkg_palettes_LUT(void) {
+void init_palettes(void) {
 
-	for (uint8_t i = 0; i < MAX_HARDWARE_PALETTES; i++) {
-		current_bkg_palettes_LUT[i] = NULL;
-	}
+	// NOTE: make a function like this per 'SCENE', dont need to use all palette slots
 
-}
+	clear_palettes_LUT();
+	fade_use_ladders(palette_ladders, PALETTE_LADDERS_COUNT); // baked fades to and from black and white
 
-void clear_current_sprite_palettes_LUT(void) {
+	acquire_bkg_palette(palette_reds); // slot 0 is reserved, these land in 1..6
+	acquire_bkg_palette(palette_greens);
+	acquire_bkg_palette(palette_blues);
+	acquire_bkg_palette(palette_oranges);
+	acquire_bkg_palette(palette_cyans);
+	acquire_bkg_palette(palette_purples);
 
-	for (uint8_t i = 0; i < MAX_HARDWARE_PALETTES; i++) {
-		current_sprite_palettes_LUT[i] = NULL;
-	}
+	acquire_sprite_palette(palette_reds);
+	acquire_sprite_palette(palette_greens);
+	acquire_sprite_palette(palette_blues);
+	acquire_sprite_palette(palette_oranges);
+	acquire_sprite_palette(palette_cyans);
+	acquire_sprite_palette(palette_purples);
 
-}
+	stage_palettes(); // set all palettes at once, in VBlank
 
-void init_palettes(void) {
+}
 
-	// NOTE: make a function like this per 'SCENE', dont need to use all palette slots
+void print_controls(void) {
 
-	clear_current_bkg_palettes_LUT();
-	clear_current_sprite_palettes_LUT();
-
-	set_bkg_palette(1, 1, palette_reds); // TODO: how to set multiple palettes at once?
-	current_bkg_palettes_LUT[1] = palette_reds;
-	set_bkg_palette(2, 1, palette_greens);
-	current_bkg_palettes_LUT[2] = palette_greens;
-	set_bkg_palette(3, 1, palette_blues);
-	current_bkg_palettes_LUT[3] = palette_blues;
-	set_bkg_palette(4, 1, palette_oranges);
-	current_bkg_palettes_LUT[4] = palette_oranges;
-	set_bkg_palette(5, 1, palette_cyans);
-	current_bkg_palettes_LUT[5] = palette_cyans;
-	set_bkg_palette(6, 1, palette_purples);
-	current_bkg_palettes_LUT[6] = palette_purples;
-	
-	set_sprite_palette(1, 1, palette_reds);
-	current_sprite_palettes_LUT[1] = palette_reds;
-	set_sprite_palette(2, 1, palette_greens);
-	current_sprite_palettes_LUT[2] = palette_greens;
-	set_sprite_palette(3, 1, palette_blues);
-	current_sprite_palettes_LUT[3] = palette_blues;
-	set_sprite_palette(4, 1, palette_oranges);
-	current_sprite_palettes_LUT[4] = palette_oranges;
-	set_sprite_palette(5, 1, palette_cyans);
-	current_sprite_palettes_LUT[5] = palette_cyans;
-	set_sprite_palette(6, 1, palette_purples);
-	current_sprite_palettes_LUT[6] = palette_purples;
+	gotoxy(1, 13);
+	printf("  A:   Randomize  ");
+	gotoxy(1, 14);
+	printf("  B:   Fade       ");
+	gotoxy(1, 15);
+	if (to_black) printf("  SL:  Black      ");
+	else printf("  SL:  White      ");
+	gotoxy(1, 16);
+	printf("  ST:  Reset      ");
 
 }
 
@@ -333,22 +252,19 @@ void init_scene(void) {
 	gotoxy(1, 8);
 	printf("BKG: ");
 
+	gotoxy(1, 10);
+	printf("SKIPPED: 0");
+
 	gotoxy(1, 12);
 	printf("------------------");
-	gotoxy(1, 13);
-	printf("  A:   Randomize  ");
-	gotoxy(1, 14);
-	printf("  B:   Fade       ");
-	gotoxy(1, 15);
-	printf("  SL:  Black      ");
-	gotoxy(1, 16);
-	printf("  ST:  Reset      ");
+
+	print_controls();
 
 }
 
 void init_sprites(void) {
 
-	set_sprite_data(0, 4, basic_tiles); // tile-data
+	vram_copy_now(_VRAM8000, basic_tiles, sizeof(basic_tiles), VBK_TILES); // tile-data, sprite tiles 0-3
 
 	set_sprite_tile(0, 0); // oam-data
 	set_sprite_tile(1, 1);
@@ -364,7 +280,7 @@ void init_sprites(void) {
 
 void init_backgrounds(void) {
 
-	set_bkg_data(128, 4, basic_tiles); // tile-data
+	vram_copy_now(_VRAM8000 + (128 * VRAM_TILE_BYTES), basic_tiles, sizeof(basic_tiles), VBK_TILES); // tile-data, bkg tiles 128-131
 
 	uint8_t tile_1 = 128; // { 0x80 }
 	uint8_t tile_2 = 129; // { 0x81 }
@@ -389,562 +305,112 @@ void randomize_palette_assignments(void) { // randomly assign a loaded-palette t
 	uint8_t rand_num;
 
 	rand_num = (arand() % 6) + 1; // random between 0-5, then + 1 for 1-6
-	set_sprite_prop(0, rand_num); // oam-prop / palette
+	attr_set_sprite_palette(0, rand_num); // oam-prop / palette
 	
 	rand_num = (arand() % 6) + 1;
-	set_sprite_prop(1, rand_num);
+	attr_set_sprite_palette(1, rand_num);
 
 	rand_num = (arand() % 6) + 1;
-	set_sprite_prop(2, rand_num);
+	attr_set_sprite_palette(2, rand_num);
 
 	rand_num = (arand() % 6) + 1;
-	set_sprite_prop(3, rand_num);
+	attr_set_sprite_palette(3, rand_num);
 
 	rand_num = (arand() % 6) + 1;
-	set_bkg_attribute_xy(6, 8, rand_num); // bkg-prop / palette
+	attr_set_palette(6, 8, rand_num); // bkg-prop / palette
 
 	rand_num = (arand() % 6) + 1;
-	set_bkg_attribute_xy(7, 8, rand_num);
+	attr_set_palette(7, 8, rand_num);
 
 	rand_num = (arand() % 6) + 1;
-	set_bkg_attribute_xy(8, 8, rand_num);
+	attr_set_palette(8, 8, rand_num);
 
 	rand_num = (arand() % 6) + 1;
-	set_bkg_attribute_xy(9, 8, rand_num);
-
-}
-
-void fade_palette_to_color_from_black(uint16_t palette_to_edit[PALETTE_SIZE], const uint16_t original_palette[PALETTE_SIZE]) {
-
-	// TODO: maybe instead of incrementing all RGB values at once, implement a threshold (hiwater) where only values above are incremented
-
-	for (int i = 0; i < PALETTE_SIZE; i++) {
-		uint16_t color = palette_to_edit[i]; // grab one of the 4 colors of the palette
-		uint16_t original_color = original_palette[i]; // grab the original color from the original palette
-
-		uint8_t r = color & 0x1F; // extract red, green, blue values from 5-bit color
-		uint8_t g = (color >> 5) & 0x1F;
-		uint8_t b = (color >> 10) & 0x1F;
-
-		uint8_t original_r = original_color & 0x1F; // extract original red, green, blue values from 5-bit color
-		uint8_t original_g = (original_color >> 5) & 0x1F;
-		uint8_t original_b = (original_color >> 10) & 0x1F;
-
-		r = (r < original_r) ? (original_r - r > FADE_STEP_GBC ? r + FADE_STEP_GBC : original_r) : original_r; // add step-amount, but clamp value to original-value
-		g = (g < original_g) ? (original_g - g > FADE_STEP_GBC ? g + FADE_STEP_GBC : original_g) : original_g;
-		b = (b < original_b) ? (original_b - b > FADE_STEP_GBC ? b + FADE_STEP_GBC : original_b) : original_b;
-
-		palette_to_edit[i] = RGB(r, g, b); // set new color to pallete
-	}
+	attr_set_palette(9, 8, rand_num);
 
 }
 
-void fade_palette_to_color_from_white(uint16_t palette_to_edit[PALETTE_SIZE], const uint16_t original_palette[PALETTE_SIZE]) {
-
-	// TODO: maybe instead of decrementing all RGB values at once, implement a threshold (hiwater) where only values above are decremented
-
-	for (int i = 0; i < PALETTE_SIZE; i++) {
-		uint16_t color = palette_to_edit[i]; // grab one of the 4 colors of the palette
-		uint16_t original_color = original_palette[i]; // grab the original color from the original palette
+#ifdef FADE_PROFILE
+void print_profile_overlay(void) { // scanlines min/max/avg and overruns per phase, of the last fade
 
-		uint8_t r = color & 0x1F; // extract red, green, blue values from 5-bit color
-		uint8_t g = (color >> 5) & 0x1F;
-		uint8_t b = (color >> 10) & 0x1F;
-
-		uint8_t original_r = original_color & 0x1F; // extract original red, green, blue values from 5-bit color
-		uint8_t original_g = (original_color >> 5) & 0x1F;
-		uint8_t original_b = (original_color >> 10) & 0x1F;
-
-		r = (r > original_r) ? (r - FADE_STEP_GBC > original_r ? r - FADE_STEP_GBC : original_r) : original_r;  // subtract step-amount, but clamp value to original-value
-		g = (g > original_g) ? (g - FADE_STEP_GBC > original_g ? g - FADE_STEP_GBC : original_g) : original_g;
-		b = (b > original_b) ? (b - FADE_STEP_GBC > original_b ? b - FADE_STEP_GBC : original_b) : original_b;
-
-		palette_to_edit[i] = RGB(r, g, b); // set new color to palette
+	for (uint8_t i = 0; i < PROFILE_PHASES; i++) {
+		gotoxy(1, 13 + i);
+		printf("                  ");
+		gotoxy(1, 13 + i);
+		printf("%s %u/%u/%u !%u", profile_phase_names[i], profile_phases[i].lines_min, profile_phases[i].lines_max, profile_lines_avg(i), (uint16_t)profile_phases[i].overruns);
 	}
 
 }
 
-void fade_palette_to_black(uint16_t palette_to_edit[PALETTE_SIZE]) {
-
-	// TODO: maybe instead of decrementing all RGB values at once, implement a threshold (hiwater) where only values above are decremented
+void toggle_profile_overlay(void) {
 
-	for (int i = 0; i < PALETTE_SIZE; i++) {
-		uint16_t color = palette_to_edit[i]; // grab one of the 4 colors of the palette
+	is_profile_overlay = !is_profile_overlay;
 
-		uint8_t r = color & 0x1F; // extract red, green, blue values from 5-bit color
-		uint8_t g = (color >> 5) & 0x1F;
-		uint8_t b = (color >> 10) & 0x1F;
-
-		r = r > FADE_STEP_GBC ? r - FADE_STEP_GBC : 0; // subtract step-amount, but clamp value to 0
-		g = g > FADE_STEP_GBC ? g - FADE_STEP_GBC : 0;
-		b = b > FADE_STEP_GBC ? b - FADE_STEP_GBC : 0;
-
-		palette_to_edit[i] = RGB(r, g, b); // set new color to pallete
-	}
+	if (is_profile_overlay) print_profile_overlay();
+	else print_controls();
 
 }
+#endif
 
-void fade_palette_to_white(uint16_t palette_to_edit[PALETTE_SIZE]) {
+void print_fade_stats(void) { // once a fade finished
 
-	// TODO: maybe instead of incrementing all RGB values at once, implement a threshold (hiwater) where only values above are incremented
+	static bool was_fading = FALSE;
 
-	for (int i = 0; i < PALETTE_SIZE; i++) {
-		uint16_t color = palette_to_edit[i]; // grab one of the 4 colors of the palette
+	if (was_fading && !is_fading) {
+		gotoxy(10, 10);
+		printf("%u", fade_skipped_uploads);
 
-		uint8_t r = color & 0x1F; // extract red, green, blue values from 5-bit color
-		uint8_t g = (color >> 5) & 0x1F;
-		uint8_t b = (color >> 10) & 0x1F;
-
-		r = r < 27 ? r + FADE_STEP_GBC : 31; // add step-amount, but clamp value to 31
-		g = g < 27 ? g + FADE_STEP_GBC : 31;
-		b = b < 27 ? b + FADE_STEP_GBC : 31;
-
-		palette_to_edit[i] = RGB(r, g, b); // set new color to pallete
+#ifdef FADE_PROFILE
+		if (is_profile_overlay) print_profile_overlay();
+#endif
 	}
 
-}
-
-static inline void copy_current_palettes_to_wram(void) { // copy currently used const palettes to WRAM to edit values
-
-	//+ --  BKG  -- +//
-
-	if (current_bkg_palettes_LUT[1] != NULL) memcpy(palette_bkg_to_edit_1, current_bkg_palettes_LUT[1], PALETTE_BYTES);
-	else palette_bkg_to_edit_1[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[2] != NULL) memcpy(palette_bkg_to_edit_2, current_bkg_palettes_LUT[2], PALETTE_BYTES);
-	else palette_bkg_to_edit_2[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[3] != NULL) memcpy(palette_bkg_to_edit_3, current_bkg_palettes_LUT[3], PALETTE_BYTES);
-	else palette_bkg_to_edit_3[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[4] != NULL) memcpy(palette_bkg_to_edit_4, current_bkg_palettes_LUT[4], PALETTE_BYTES);
-	else palette_bkg_to_edit_4[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[5] != NULL) memcpy(palette_bkg_to_edit_5, current_bkg_palettes_LUT[5], PALETTE_BYTES);
-	else palette_bkg_to_edit_5[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[6] != NULL) memcpy(palette_bkg_to_edit_6, current_bkg_palettes_LUT[6], PALETTE_BYTES);
-	else palette_bkg_to_edit_6[0] = PALETTE_NULL_FLAG;
-
-	//+ --  SPRITES  -- +//
-
-	if (current_sprite_palettes_LUT[1] != NULL) memcpy(palette_sprite_to_edit_1, current_sprite_palettes_LUT[1], PALETTE_BYTES);
-	else palette_sprite_to_edit_1[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[2] != NULL) memcpy(palette_sprite_to_edit_2, current_sprite_palettes_LUT[2], PALETTE_BYTES);
-	else palette_sprite_to_edit_2[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[3] != NULL) memcpy(palette_sprite_to_edit_3, current_sprite_palettes_LUT[3], PALETTE_BYTES);
-	else palette_sprite_to_edit_3[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[4] != NULL) memcpy(palette_sprite_to_edit_4, current_sprite_palettes_LUT[4], PALETTE_BYTES);
-	else palette_sprite_to_edit_4[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[5] != NULL) memcpy(palette_sprite_to_edit_5, current_sprite_palettes_LUT[5], PALETTE_BYTES);
-	else palette_sprite_to_edit_5[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[6] != NULL) memcpy(palette_sprite_to_edit_6, current_sprite_palettes_LUT[6], PALETTE_BYTES);
-	else palette_sprite_to_edit_6[0] = PALETTE_NULL_FLAG;
-
-	vsync(); // NOTE: saftey - cycle overflow
+	was_fading = is_fading;
 
 }
 
-static inline void copy_black_palette_to_wram(void) { // copy black palette to WRAM to edit values
-
-	//+ --  BKG  -- +//
-
-	if (current_bkg_palettes_LUT[1] != NULL) memcpy(palette_bkg_to_edit_1, palette_all_black, PALETTE_BYTES);
-	else palette_bkg_to_edit_1[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[2] != NULL) memcpy(palette_bkg_to_edit_2, palette_all_black, PALETTE_BYTES);
-	else palette_bkg_to_edit_2[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[3] != NULL) memcpy(palette_bkg_to_edit_3, palette_all_black, PALETTE_BYTES);
-	else palette_bkg_to_edit_3[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[4] != NULL) memcpy(palette_bkg_to_edit_4, palette_all_black, PALETTE_BYTES);
-	else palette_bkg_to_edit_4[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[5] != NULL) memcpy(palette_bkg_to_edit_5, palette_all_black, PALETTE_BYTES);
-	else palette_bkg_to_edit_5[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[6] != NULL) memcpy(palette_bkg_to_edit_6, palette_all_black, PALETTE_BYTES);
-	else palette_bkg_to_edit_6[0] = PALETTE_NULL_FLAG;
-
-	//+ --  SPRITES  -- +//
-
-	if (current_sprite_palettes_LUT[1] != NULL) memcpy(palette_sprite_to_edit_1, palette_all_black, PALETTE_BYTES);
-	else palette_sprite_to_edit_1[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[2] != NULL) memcpy(palette_sprite_to_edit_2, palette_all_black, PALETTE_BYTES);
-	else palette_sprite_to_edit_2[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[3] != NULL) memcpy(palette_sprite_to_edit_3, palette_all_black, PALETTE_BYTES);
-	else palette_sprite_to_edit_3[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[4] != NULL) memcpy(palette_sprite_to_edit_4, palette_all_black, PALETTE_BYTES);
-	else palette_sprite_to_edit_4[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[5] != NULL) memcpy(palette_sprite_to_edit_5, palette_all_black, PALETTE_BYTES);
-	else palette_sprite_to_edit_5[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[6] != NULL) memcpy(palette_sprite_to_edit_6, palette_all_black, PALETTE_BYTES);
-	else palette_sprite_to_edit_6[0] = PALETTE_NULL_FLAG;
-
-	vsync(); // NOTE: saftey - cycle overflow
-
-}
-
-static inline void copy_white_palette_to_wram(void) { // copy white palette to WRAM to edit values
-
-	//+ --  BKG  -- +//
-
-	if (current_bkg_palettes_LUT[1] != NULL) memcpy(palette_bkg_to_edit_1, palette_all_white, PALETTE_BYTES);
-	else palette_bkg_to_edit_1[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[2] != NULL) memcpy(palette_bkg_to_edit_2, palette_all_white, PALETTE_BYTES);
-	else palette_bkg_to_edit_2[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[3] != NULL) memcpy(palette_bkg_to_edit_3, palette_all_white, PALETTE_BYTES);
-	else palette_bkg_to_edit_3[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[4] != NULL) memcpy(palette_bkg_to_edit_4, palette_all_white, PALETTE_BYTES);
-	else palette_bkg_to_edit_4[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[5] != NULL) memcpy(palette_bkg_to_edit_5, palette_all_white, PALETTE_BYTES);
-	else palette_bkg_to_edit_5[0] = PALETTE_NULL_FLAG;
-
-	if (current_bkg_palettes_LUT[6] != NULL) memcpy(palette_bkg_to_edit_6, palette_all_white, PALETTE_BYTES);
-	else palette_bkg_to_edit_6[0] = PALETTE_NULL_FLAG;
-
-	//+ --  SPRITES  -- +//
-
-	if (current_sprite_palettes_LUT[1] != NULL) memcpy(palette_sprite_to_edit_1, palette_all_white, PALETTE_BYTES);
-	else palette_sprite_to_edit_1[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[2] != NULL) memcpy(palette_sprite_to_edit_2, palette_all_white, PALETTE_BYTES);
-	else palette_sprite_to_edit_2[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[3] != NULL) memcpy(palette_sprite_to_edit_3, palette_all_white, PALETTE_BYTES);
-	else palette_sprite_to_edit_3[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[4] != NULL) memcpy(palette_sprite_to_edit_4, palette_all_white, PALETTE_BYTES);
-	else palette_sprite_to_edit_4[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[5] != NULL) memcpy(palette_sprite_to_edit_5, palette_all_white, PALETTE_BYTES);
-	else palette_sprite_to_edit_5[0] = PALETTE_NULL_FLAG;
-
-	if (current_sprite_palettes_LUT[6] != NULL) memcpy(palette_sprite_to_edit_6, palette_all_white, PALETTE_BYTES);
-	else palette_sprite_to_edit_6[0] = PALETTE_NULL_FLAG;
-
-	vsync(); // NOTE: saftey - cycle overflow
-
-}
-
-void fade_to_color_from_black_gbc(void) {
-
-	// NOTE: not fading palette-0, to keep the background text
-
-	copy_black_palette_to_wram(); // NOTE: subengine - copy black palette to WRAM to edit values
-
-	uint8_t fade_counter = FADE_STEP_COUNTER_GBC;
-
-	while (fade_counter > 0) {
-
-		if (palette_bkg_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_bkg_to_edit_1, current_bkg_palettes_LUT[1]); // fade
-			set_bkg_palette(1, 1, palette_bkg_to_edit_1); // set palette
-		}
-		if (palette_bkg_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_bkg_to_edit_2, current_bkg_palettes_LUT[2]);
-			set_bkg_palette(2, 1, palette_bkg_to_edit_2);
-		}
-		if (palette_bkg_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_bkg_to_edit_3, current_bkg_palettes_LUT[3]);
-			set_bkg_palette(3, 1, palette_bkg_to_edit_3);
-		}
-		if (palette_bkg_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_bkg_to_edit_4, current_bkg_palettes_LUT[4]);
-			set_bkg_palette(4, 1, palette_bkg_to_edit_4);
-		}
-		if (palette_bkg_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_bkg_to_edit_5, current_bkg_palettes_LUT[5]);
-			set_bkg_palette(5, 1, palette_bkg_to_edit_5);
-		}
-		if (palette_bkg_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_bkg_to_edit_6, current_bkg_palettes_LUT[6]);
-			set_bkg_palette(6, 1, palette_bkg_to_edit_6);
-		}
-
-		if (palette_sprite_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_sprite_to_edit_1, current_sprite_palettes_LUT[1]);
-			set_sprite_palette(1, 1, palette_sprite_to_edit_1);
-		}
-		if (palette_sprite_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_sprite_to_edit_2, current_sprite_palettes_LUT[2]);
-			set_sprite_palette(2, 1, palette_sprite_to_edit_2);
-		}
-		if (palette_sprite_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_sprite_to_edit_3, current_sprite_palettes_LUT[3]);
-			set_sprite_palette(3, 1, palette_sprite_to_edit_3);
-		}
-		if (palette_sprite_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_sprite_to_edit_4, current_sprite_palettes_LUT[4]);
-			set_sprite_palette(4, 1, palette_sprite_to_edit_4);
-		}
-		if (palette_sprite_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_sprite_to_edit_5, current_sprite_palettes_LUT[5]);
-			set_sprite_palette(5, 1, palette_sprite_to_edit_5);
-		}
-		if (palette_sprite_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_black(palette_sprite_to_edit_6, current_sprite_palettes_LUT[6]);
-			set_sprite_palette(6, 1, palette_sprite_to_edit_6);
-		}
-
-		vsync();
-		if (fade_counter > 1) { vsync(); vsync(); } // adding extra time
-
-		fade_counter--;
-	}
-
-	is_faded = FALSE;
-
-}
-
-void fade_to_color_from_white_gbc(void) {
-
-	// NOTE: not fading palette-0, to keep the background text
-
-	copy_white_palette_to_wram(); // NOTE: subengine - copy black palette to WRAM to edit values
-
-	uint8_t fade_counter = FADE_STEP_COUNTER_GBC;
-
-	while (fade_counter > 0) {
-
-		if (palette_bkg_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_bkg_to_edit_1, current_bkg_palettes_LUT[1]); // fade
-			set_bkg_palette(1, 1, palette_bkg_to_edit_1); // set palette
-		}
-		if (palette_bkg_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_bkg_to_edit_2, current_bkg_palettes_LUT[2]);
-			set_bkg_palette(2, 1, palette_bkg_to_edit_2);
-		}
-		if (palette_bkg_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_bkg_to_edit_3, current_bkg_palettes_LUT[3]);
-			set_bkg_palette(3, 1, palette_bkg_to_edit_3);
-		}
-		if (palette_bkg_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_bkg_to_edit_4, current_bkg_palettes_LUT[4]);
-			set_bkg_palette(4, 1, palette_bkg_to_edit_4);
-		}
-		if (palette_bkg_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_bkg_to_edit_5, current_bkg_palettes_LUT[5]);
-			set_bkg_palette(5, 1, palette_bkg_to_edit_5);
-		}
-		if (palette_bkg_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_bkg_to_edit_6, current_bkg_palettes_LUT[6]);
-			set_bkg_palette(6, 1, palette_bkg_to_edit_6);
-		}
-
-		if (palette_sprite_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_sprite_to_edit_1, current_sprite_palettes_LUT[1]);
-			set_sprite_palette(1, 1, palette_sprite_to_edit_1);
-		}
-		if (palette_sprite_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_sprite_to_edit_2, current_sprite_palettes_LUT[2]);
-			set_sprite_palette(2, 1, palette_sprite_to_edit_2);
-		}
-		if (palette_sprite_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_sprite_to_edit_3, current_sprite_palettes_LUT[3]);
-			set_sprite_palette(3, 1, palette_sprite_to_edit_3);
-		}
-		if (palette_sprite_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_sprite_to_edit_4, current_sprite_palettes_LUT[4]);
-			set_sprite_palette(4, 1, palette_sprite_to_edit_4);
-		}
-		if (palette_sprite_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_sprite_to_edit_5, current_sprite_palettes_LUT[5]);
-			set_sprite_palette(5, 1, palette_sprite_to_edit_5);
-		}
-		if (palette_sprite_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_color_from_white(palette_sprite_to_edit_6, current_sprite_palettes_LUT[6]);
-			set_sprite_palette(6, 1, palette_sprite_to_edit_6);
-		}
-
-		vsync();
-		if (fade_counter > 1) { vsync(); vsync(); } // adding extra time
-
-		fade_counter--;
-	}
-
-	is_faded = FALSE;
-
-}
-
-void fade_to_black_gbc(void) {
-
-	// NOTE: not fading palette-0, to keep the background text
-
-	copy_current_palettes_to_wram(); // NOTE: subengine - copy currently used const palettes to WRAM to edit values
-
-	uint8_t fade_counter = FADE_STEP_COUNTER_GBC;
-
-	while (fade_counter > 0) {
-
-		if (palette_bkg_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_bkg_to_edit_1); // fade
-			set_bkg_palette(1, 1, palette_bkg_to_edit_1); // set palette
-		}
-		if (palette_bkg_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_bkg_to_edit_2);
-			set_bkg_palette(2, 1, palette_bkg_to_edit_2);
-		}
-		if (palette_bkg_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_bkg_to_edit_3);
-			set_bkg_palette(3, 1, palette_bkg_to_edit_3);
-		}
-		if (palette_bkg_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_bkg_to_edit_4);
-			set_bkg_palette(4, 1, palette_bkg_to_edit_4);
-		}
-		if (palette_bkg_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_bkg_to_edit_5);
-			set_bkg_palette(5, 1, palette_bkg_to_edit_5);
-		}
-		if (palette_bkg_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_bkg_to_edit_6);
-			set_bkg_palette(6, 1, palette_bkg_to_edit_6);
-		}
-
-		if (palette_sprite_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_sprite_to_edit_1);
-			set_sprite_palette(1, 1, palette_sprite_to_edit_1);
-		}
-		if (palette_sprite_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_sprite_to_edit_2);
-			set_sprite_palette(2, 1, palette_sprite_to_edit_2);
-		}
-		if (palette_sprite_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_sprite_to_edit_3);
-			set_sprite_palette(3, 1, palette_sprite_to_edit_3);
-		}
-		if (palette_sprite_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_sprite_to_edit_4);
-			set_sprite_palette(4, 1, palette_sprite_to_edit_4);
-		}
-		if (palette_sprite_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_sprite_to_edit_5);
-			set_sprite_palette(5, 1, palette_sprite_to_edit_5);
-		}
-		if (palette_sprite_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_black(palette_sprite_to_edit_6);
-			set_sprite_palette(6, 1, palette_sprite_to_edit_6);
-		}
-
-		vsync();
-		if (fade_counter > 1) { vsync(); vsync(); } // adding extra time
-
-		fade_counter--;
-	}
-
-	is_faded = TRUE;
-
-}
-
-void fade_to_white_gbc(void) {
-
-	// NOTE: not fading palette-0, to keep the background text
-
-	copy_current_palettes_to_wram(); // NOTE: subengine - copy currently used const palettes to WRAM to edit values
-
-	uint8_t fade_counter = FADE_STEP_COUNTER_GBC;
-
-	while (fade_counter > 0) {
-
-		if (palette_bkg_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_bkg_to_edit_1); // fade
-			set_bkg_palette(1, 1, palette_bkg_to_edit_1); // set palette
-		}
-		if (palette_bkg_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_bkg_to_edit_2);
-			set_bkg_palette(2, 1, palette_bkg_to_edit_2);
-		}
-		if (palette_bkg_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_bkg_to_edit_3);
-			set_bkg_palette(3, 1, palette_bkg_to_edit_3);
-		}
-		if (palette_bkg_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_bkg_to_edit_4);
-			set_bkg_palette(4, 1, palette_bkg_to_edit_4);
-		}
-		if (palette_bkg_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_bkg_to_edit_5);
-			set_bkg_palette(5, 1, palette_bkg_to_edit_5);
-		}
-		if (palette_bkg_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_bkg_to_edit_6);
-			set_bkg_palette(6, 1, palette_bkg_to_edit_6);
-		}
-
-		if (palette_sprite_to_edit_1[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_sprite_to_edit_1);
-			set_sprite_palette(1, 1, palette_sprite_to_edit_1);
-		}
-		if (palette_sprite_to_edit_2[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_sprite_to_edit_2);
-			set_sprite_palette(2, 1, palette_sprite_to_edit_2);
-		}
-		if (palette_sprite_to_edit_3[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_sprite_to_edit_3);
-			set_sprite_palette(3, 1, palette_sprite_to_edit_3);
-		}
-		if (palette_sprite_to_edit_4[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_sprite_to_edit_4);
-			set_sprite_palette(4, 1, palette_sprite_to_edit_4);
-		}
-		if (palette_sprite_to_edit_5[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_sprite_to_edit_5);
-			set_sprite_palette(5, 1, palette_sprite_to_edit_5);
-		}
-		if (palette_sprite_to_edit_6[0] != PALETTE_NULL_FLAG) {
-			fade_palette_to_white(palette_sprite_to_edit_6);
-			set_sprite_palette(6, 1, palette_sprite_to_edit_6);
-		}
-
-		vsync();
-		if (fade_counter > 1) { vsync(); vsync(); } // adding extra time
-
-		fade_counter--;
-	}
-
-	is_faded = TRUE;
-}
-
 void handle_inputs(void) {
 
 	static uint8_t prev_joypad = NULL;
 	uint8_t current_joypad = joypad();
 
+#ifdef FADE_PROFILE
+	if ((current_joypad & (J_SELECT | J_START)) == (J_SELECT | J_START) && (prev_joypad & J_START) == 0) { // hold SELECT, press START
+		toggle_profile_overlay();
+		prev_joypad = current_joypad;
+		return;
+	}
+#endif
+
 	if ((current_joypad & J_A) && !(prev_joypad & J_A)) {
-		if (!is_faded) { randomize_palette_assignments(); sfx_1(); }
+		if (!is_faded && !is_fading) { randomize_palette_assignments(); sfx_1(); }
 	}
 	else if ((current_joypad & J_B) && !(prev_joypad & J_B)) {
-		if (!is_faded) {
+		if (is_fading) { // NOTE: turn around mid-fade, from the current colors
+			if (is_faded) sfx_3();
+			else sfx_4();
+			fade_reverse();
+			is_faded = !is_faded;
+		} else if (!is_faded) {
 			sfx_4();
-			if (to_black) fade_to_black_gbc();
-			else fade_to_white_gbc();
+			if (to_black) fade_start(FADE_TO_BLACK, FADE_EXCLUDE_TEXT);
+			else fade_start(FADE_TO_WHITE, FADE_EXCLUDE_TEXT);
+			is_faded = TRUE;
 		} else {
 			sfx_3();
-			if (to_black) fade_to_color_from_black_gbc();
-			else fade_to_color_from_white_gbc();
+			if (to_black) fade_start(FADE_FROM_BLACK, FADE_EXCLUDE_TEXT);
+			else fade_start(FADE_FROM_WHITE, FADE_EXCLUDE_TEXT);
+			is_faded = FALSE;
 		}
 	}
 	else if ((current_joypad & J_SELECT) && !(prev_joypad & J_SELECT)) {
-		if (is_faded) return; // dont allow changing color if faded
+		if (is_faded || is_fading) return; // dont allow changing color if faded
 
 		to_black = !to_black;
 		sfx_2();
+#ifdef FADE_PROFILE
+		if (is_profile_overlay) { prev_joypad = current_joypad; return; } // NOTE: controls text hidden
+#endif
 		if (to_black) {
 			gotoxy(1, 15);
 			printf("  SL:  Black      ");
@@ -969,6 +435,7 @@ void handle_inputs(void) {
 void gbc_only_error(void) {
 
 	if (!is_gbc) {
+		DISPLAY_ON;
 		while (TRUE) {
 			gotoxy(6, 7);
 			printf("GBC ONLY");
@@ -991,6 +458,10 @@ void init_game(void) {
 	init_backgrounds();
 
 	randomize_palette_assignments(); // randomly assign a loaded-palette to each sprite and bkg-tile
+	attr_flush(); // NOTE: LCD off, no VBlank to flush in
+
+	DISPLAY_ON; // NOTE: once, the palettes staged above upload in the first VBlank
+	PROFILE_STARTUP_END();
 
 }
 
@@ -1005,7 +476,11 @@ void main(void) {
 
 	while (TRUE) {
 		handle_inputs();
+		fade_update(); // NOTE: at most one fade-step per frame
+		print_fade_stats();
 		vsync();
+		speed_update(); // NOTE: before the General DMA, which can run until line 152
+		vram_update(); // NOTE: in VBlank, queued tile and map uploads, none after a speed switch
 	}
 
 }
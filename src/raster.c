@@ -0,0 +1,155 @@
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+
+#include "fade.h"
+#include "raster.h"
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+const raster_entry_t* raster_table; // table drawn this frame, only touched by the handlers
+uint8_t raster_count;
+uint8_t raster_next; // next entry of raster_table
+uint16_t raster_slots_mask; // palettes raster_table changes, restored every VBlank by palette_vbl_isr()
+
+const raster_entry_t* raster_submitted_table; // latched in VBlank
+uint8_t raster_submitted_count;
+uint16_t raster_submitted_mask;
+volatile bool is_raster_submitted;
+
+uint16_t raster_late_writes;
+uint16_t raster_dropped_writes;
+
+uint8_t raster_hblank_write(const raster_entry_t* entry); // src/raster_hblank.s, lines late
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  HANDLERS  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void raster_vbl_isr(void) { // after palette_vbl_isr(): arm the first entry, the palettes it changes go back in the next VBlank
+
+	if (is_raster_submitted) {
+		raster_table = raster_submitted_table;
+		raster_count = raster_submitted_count;
+		raster_slots_mask = raster_submitted_mask;
+		is_raster_submitted = FALSE;
+	}
+
+	if (raster_count != 0) palette_restore_mask |= raster_slots_mask; // NOTE: uploaded with the dirty ones, inside their line budget
+
+	raster_next = 0;
+	LYC_REG = (raster_count != 0) ? raster_table[0].line - RASTER_LYC_LEAD : RASTER_LINE_NONE;
+
+}
+
+void raster_lcd_isr(void) { // LYC, RASTER_LYC_LEAD lines ahead: every entry until the next one far enough to rearm
+
+	const raster_entry_t* entry;
+	uint8_t late;
+	uint8_t saved_bank = CURRENT_BANK; // NOTE: whatever the interrupted code had mapped
+
+	do {
+		entry = &raster_table[raster_next++];
+
+		if (entry->bank != 0) SWITCH_ROM(entry->bank);
+
+		late = raster_hblank_write(entry);
+		if (late == 0xFF) {
+			raster_dropped_writes++; // NOTE: the VBlank upload shows the palettes before the table
+		} else if (late != 0) {
+			raster_late_writes++; // NOTE: still written, torn for a line or more
+		}
+
+		if (raster_next == raster_count) break;
+	} while (raster_table[raster_next].line <= LY_REG + RASTER_LYC_LEAD + 1); // NOTE: too close for LYC, wait here
+
+	if (CURRENT_BANK != saved_bank) SWITCH_ROM(saved_bank);
+
+	LYC_REG = (raster_next == raster_count) ? RASTER_LINE_NONE : raster_table[raster_next].line - RASTER_LYC_LEAD;
+
+}
+
+void raster_init(void) {
+
+	raster_count = 0;
+	raster_slots_mask = 0;
+	is_raster_submitted = FALSE;
+
+	CRITICAL {
+		LYC_REG = RASTER_LINE_NONE;
+		STAT_REG |= STATF_LYC;
+
+		add_VBL(raster_vbl_isr); // NOTE: after palette_vbl_isr(), which takes the restore mask set here
+		add_LCD(raster_lcd_isr);
+	}
+
+	set_interrupts(IE_REG | LCD_IFLAG);
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void raster_submit(const raster_entry_t* entries, uint8_t count) { // table for the next frame on, sorted by line
+
+	uint16_t mask = 0;
+
+	for (uint8_t i = 0; i < count; i++) {
+		mask |= PALETTE_MASK_SLOT(entries[i].slot);
+	}
+
+	CRITICAL {
+		raster_submitted_table = entries;
+		raster_submitted_count = count;
+		raster_submitted_mask = mask;
+		is_raster_submitted = TRUE;
+	}
+
+}
+
+void raster_clear(void) { // back to one set of palettes per frame, from the next frame on
+
+	raster_submit(NULL, 0);
+
+}
+
+uint8_t raster_band(raster_entry_t* entries, uint16_t mask, uint8_t top, uint8_t bottom, const palette_color_t* const* inside, const palette_color_t* const* outside, uint8_t bank) { // entries switching mask to inside from line top, back to outside from line bottom, colors read from ROM bank
+
+	// NOTE: one palette per line, the edges of a band are as tall as the palettes in mask
+	// NOTE: wipe: bottom = RASTER_LINE_END, iris: the VBlank upload shows outside above top
+
+	uint8_t count = 0;
+	uint8_t line = (top < RASTER_LINE_FIRST) ? RASTER_LINE_FIRST : top;
+
+	uint16_t bits = mask;
+	for (uint8_t slot = 0; bits && line < bottom && line < RASTER_LINE_END; slot++, bits >>= 1) {
+		if (!((uint8_t)bits & 0x01)) continue;
+
+		entries[count].line = line++;
+		entries[count].slot = slot;
+		entries[count].colors = inside[slot];
+		entries[count].bank = bank;
+		count++;
+	}
+
+	if (outside == NULL) return count;
+	if (line < bottom) line = bottom;
+
+	bits = mask;
+	for (uint8_t slot = 0; bits && line < RASTER_LINE_END; slot++, bits >>= 1) {
+		if (!((uint8_t)bits & 0x01)) continue;
+
+		entries[count].line = line++;
+		entries[count].slot = slot;
+		entries[count].colors = outside[slot];
+		entries[count].bank = bank;
+		count++;
+	}
+
+	return count;
+
+}
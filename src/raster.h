@@ -0,0 +1,75 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include "fade.h" // PALETTE_*, slot-index
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Raster palette engine: rewrites palettes at chosen scanlines, from a table of entries.
+
+	Each entry writes one whole palette in the HBlank before its line (src/raster_hblank.s,
+	cycle-counted to fit at single speed too). The LYC interrupt fires RASTER_LYC_LEAD lines
+	early, so the GBDK dispatch cost never eats into that window; entries on following lines
+	are written by the same interrupt.
+
+	Usage:
+		- `raster_init()` once, after `fade_init()`.
+		- fill a table sorted by line, lines RASTER_LINE_FIRST (3)-143, at most one entry per line,
+		  then `raster_submit()`: used from the next frame on. Keep it alive until the next submit,
+		  build the next one in a second table.
+		- `raster_band()` fills a table for wipes (one edge) and iris-style bands (two edges), with
+		  `fade_ladder_colors()` for colors part-way along a baked or cached fade, bank FADE_ROM_BANK.
+		- lines above the first entry show the palettes uploaded in VBlank: the touched palettes
+		  join the palette handler's upload every frame (`palette_restore_mask`), inside its line
+		  budget, and spill to the next VBlank like any other upload.
+
+	Each entry costs the CPU up to RASTER_LYC_LEAD lines waiting, and a CRITICAL section in the
+	main loop delays the interrupt: keep them short while a table is active.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ------------------------------------  RASTER MACROS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define RASTER_LINE_NONE 0xFF // LYC value that never matches
+#define RASTER_LINE_FIRST 3 // first line an entry can change, lowest LYC 1: LY already reads 0 in most of VBlank line 153
+#define RASTER_LINE_END 144 // first VBlank line
+
+#define RASTER_LYC_LEAD 2 // interrupt lines ahead of an entry, headroom for the dispatch
+
+#ifndef RASTER_MAX_ENTRIES
+#define RASTER_MAX_ENTRIES 32 // entries per table, for raster_band() callers sizing tables
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+typedef struct { // NOTE: layout read by src/raster_hblank.s
+	uint8_t line; // first line drawn with the new colors
+	uint8_t slot; // slot-index, 0-7 bkg, 8-15 sprites
+	const palette_color_t* colors;
+	uint8_t bank; // ROM bank mapped to read colors, 0: bank 0 or WRAM, no switch
+} raster_entry_t;
+
+extern uint16_t raster_late_writes; // entries written after their line started, since boot
+extern uint16_t raster_dropped_writes; // entries reached in VBlank, not written, since boot
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void raster_init(void);
+
+void raster_submit(const raster_entry_t* entries, uint8_t count);
+void raster_clear(void);
+
+uint8_t raster_band(raster_entry_t* entries, uint16_t mask, uint8_t top, uint8_t bottom, const palette_color_t* const* inside, const palette_color_t* const* outside, uint8_t bank);
+
+#endif
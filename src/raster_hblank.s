@@ -0,0 +1,121 @@
+;* ------------------------------------------------------------------------------------------- *;
+;* ------------------------------------  RASTER HBLANK  -------------------------------------- *;
+;* ------------------------------------------------------------------------------------------- *;
+
+; One palette written in the HBlank before its line, called by raster_lcd_isr().
+;
+; Palette RAM is locked only in mode 3, so the window is HBlank of line-1 plus mode 2 of line:
+;     min 87 + 80 dots = 41.75 M-cycles at single speed (10 sprites on the line), 83.5 at double.
+;
+; The write has to start at the mode 0 edge: a poll that starts part-way through HBlank cant
+; tell how much of it is left. So the wait is for mode 2 of line-1 first (20 M-cycles, the poll
+; takes <= 15 per turn and cant miss it), then for mode 0. Mode 3 lasts >= 43 M-cycles, the
+; setup between the two polls (<= 24) always ends inside it, and the second poll sees the edge.
+; Everything but the 8 data writes is done before that, 3 bytes preloaded in registers.
+; Cycles from HBlank starting, worst case:
+;     STAT poll loop             <= 8    ; ldh 3 (read on the last), and 2, jr 3
+;     and + jr out                  4
+;     3 preloaded writes            9    ; ld a,r 1 + ldh (c),a 2
+;     5 writes from (hl+)          20    ; ld a,(hl+) 2 + ldh (c),a 2
+;                                 ----
+;     last write                  <= 41 M-cycles, inside the 41.75 window at both speeds
+;
+; The wait itself costs the CPU up to RASTER_LYC_LEAD + 1 lines per entry, from the LYC line
+; (plus the interrupt dispatch) to the HBlank of line-1, 114 M-cycles a line at single speed.
+;
+; sdcccall(1): DE = raster_entry_t* { uint8_t line; uint8_t slot; const palette_color_t* colors; }
+; Returns A = lines late: 0 on time, else the write landed that many HBlanks after line-1 (the
+; lines in between are torn), 0xFF if called in VBlank (nothing written, restored there anyway).
+
+	.module raster_hblank
+
+rLY		= 0x44
+rSTAT		= 0x41
+rBCPS		= 0x68
+rOCPS		= 0x6A
+
+STAT_MODE	= 0x03
+STAT_MODE_OAM	= 0x02
+PAL_AUTOINC	= 0x80
+
+	.area	_CODE
+
+; void raster_hblank_write(const raster_entry_t* entry)
+_raster_hblank_write::
+	ld	a, (de)			; line
+	dec	a
+	ld	b, a			; B = line before, its HBlank is the window
+	inc	de
+
+	ld	a, (de)			; slot-index: 0-7 bkg, 8-15 sprites
+	inc	de
+	ld	c, #rBCPS
+	cp	#8
+	jr	c, 1$
+	ld	c, #rOCPS
+	sub	#8
+1$:
+	add	a, a
+	add	a, a
+	add	a, a
+	or	#PAL_AUTOINC
+	ldh	(c), a			; BCPS/OCPS, writable in any mode
+	inc	c			; C = BCPD/OCPD
+
+	ld	a, (de)
+	ld	l, a
+	inc	de
+	ld	a, (de)
+	ld	h, a			; HL = colors
+
+	ld	a, (hl+)
+	ld	e, a
+	ld	a, (hl+)
+	ld	d, a			; DE = color 0, preloaded
+
+2$:
+	ldh	a, (rSTAT)
+	and	#STAT_MODE
+	cp	#STAT_MODE_OAM
+	jr	z, 3$
+	dec	a
+	jr	z, 9$			; NOTE: VBlank, too late for this frame
+	jr	2$			; HBlank or drawing, wait for the next line start
+3$:
+	ldh	a, (rLY)		; NOTE: mode 2, LY cant change for another >= 63 M-cycles
+	cp	b
+	jr	c, 2$			; too early, wait for the line before
+
+	sub	b
+	push	af			; lines late
+	ld	a, (hl+)
+	ld	b, a			; B = color 1 lo, preloaded
+
+4$:
+	ldh	a, (rSTAT)
+	and	#STAT_MODE
+	jr	nz, 4$			; wait for HBlank
+
+	ld	a, e
+	ldh	(c), a
+	ld	a, d
+	ldh	(c), a
+	ld	a, b
+	ldh	(c), a
+	ld	a, (hl+)
+	ldh	(c), a
+	ld	a, (hl+)
+	ldh	(c), a
+	ld	a, (hl+)
+	ldh	(c), a
+	ld	a, (hl+)
+	ldh	(c), a
+	ld	a, (hl+)
+	ldh	(c), a
+
+	pop	af
+	ret
+
+9$:
+	ld	a, #0xFF
+	ret
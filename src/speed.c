@@ -0,0 +1,111 @@
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+
+#ifdef FADE_PROFILE
+#include <gbdk/emu_debug.h> // EMU_printf()
+#endif
+
+#include "speed.h"
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define KEY1_DOUBLE_SPEED 0x80 // read: current speed
+#define LINES_PER_FRAME 154
+#define LINE_VBLANK 144
+
+uint8_t speed_fast_refs; // pushes not popped yet
+uint8_t speed_slow_countdown; // frames left before dropping back
+uint8_t speed_deferred_frames; // switches put off for starting late in VBlank
+
+uint8_t speed_switch_lines;
+uint8_t speed_switch_lines_max;
+uint16_t speed_switches;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void speed_switch(bool is_fast) { // NOTE: interrupts off for the whole STOP, inside GBDK
+
+	uint8_t ly = LY_REG;
+
+	if (is_fast) cpu_fast();
+	else cpu_slow();
+
+	uint8_t ly_after = LY_REG;
+
+	speed_switch_lines = (ly_after >= ly) ? ly_after - ly : ly_after + (LINES_PER_FRAME - ly);
+	if (speed_switch_lines > speed_switch_lines_max) speed_switch_lines_max = speed_switch_lines;
+	speed_switches++;
+
+#ifdef FADE_PROFILE
+	EMU_printf("SPEED %s %u lines", is_fast ? "FAST" : "SLOW", (uint16_t)speed_switch_lines);
+#endif
+
+}
+
+void speed_init(void) {
+
+	speed_fast_refs = 0;
+	speed_slow_countdown = 0;
+	speed_deferred_frames = 0;
+
+}
+
+void speed_push_fast(void) {
+
+	if (_cpu != CGB_TYPE) return;
+
+	speed_fast_refs++;
+
+}
+
+void speed_pop(void) {
+
+	if (speed_fast_refs == 0) return;
+
+	speed_fast_refs--;
+	if (speed_fast_refs == 0) speed_slow_countdown = SPEED_SLOW_DELAY;
+
+}
+
+bool speed_is_fast(void) {
+
+	return (_cpu == CGB_TYPE) && (KEY1_REG & KEY1_DOUBLE_SPEED);
+
+}
+
+void speed_update(void) { // once per frame, right after vsync() and before vram_update(), the VBL handlers are done
+
+	if (_cpu != CGB_TYPE) return;
+
+	bool is_fast = (KEY1_REG & KEY1_DOUBLE_SPEED) != 0;
+
+	if (speed_fast_refs != 0) {
+		if (is_fast) return;
+	} else {
+		if (!is_fast) return;
+		if (speed_slow_countdown != 0) {
+			speed_slow_countdown--;
+			return;
+		}
+	}
+
+	if (LCDC_REG & LCDCF_ON) {
+		uint8_t ly = LY_REG;
+
+		if (ly < LINE_VBLANK) return; // NOTE: missed VBlank, next frame
+		if (ly > SPEED_SWITCH_LAST_LINE && speed_deferred_frames < SPEED_SWITCH_MAX_DEFERS) { // NOTE: the VBL handlers ran long, a switch now eats further into the frame
+			speed_deferred_frames++;
+			return;
+		}
+	}
+
+	speed_deferred_frames = 0;
+	speed_switch(!is_fast);
+
+}
@@ -0,0 +1,66 @@
+#ifndef SPEED_H
+#define SPEED_H
+
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	CPU speed on demand: double speed only while some work asks for it, GBC only.
+
+	Usage:
+		- `speed_init()` once, the game starts at single speed.
+		- `speed_push_fast()` before a burst, `speed_pop()` after it, nestable. Fades push on
+		  their own once FADE_FAST_MIN_SLOTS palettes need the kernel (src/fade.c).
+		- `speed_update()` once per frame, right after `vsync()` and before `vram_update()`: the
+		  only place the speed changes. Back to single speed SPEED_SLOW_DELAY frames after the
+		  last pop, so back-to-back fades dont pay for a switch each.
+
+	A switch is a STOP of ~2050 M-cycles with every interrupt off (GBDK cpu_fast()/cpu_slow()),
+	~18 lines at single speed, longer than the 10 lines of VBlank: it always runs into the top
+	lines of the next frame. The LCD keeps drawing, but raster entries and HBlank DMA there are
+	late, and DIV restarts. To bound that, a switch only starts up to SPEED_SWITCH_LAST_LINE,
+	so it ends by line ~10. Later starts are put off to the next frame, at most
+	SPEED_SWITCH_MAX_DEFERS times in a row, so VBL handlers that fill every VBlank (the heavy
+	fades that asked for the switch) cant hold it off for good.
+	`speed_switch_lines` / `speed_switch_lines_max` hold the cost seen on the device, in
+	scanlines, from LY before and after.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ------------------------------------  SPEED MACROS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#ifndef SPEED_SLOW_DELAY
+#define SPEED_SLOW_DELAY 30 // frames at double speed after the last pop, before dropping back
+#endif
+
+#define SPEED_SWITCH_LAST_LINE 146 // last VBlank line a switch starts on, it ends ~18 lines later
+#define SPEED_SWITCH_MAX_DEFERS 3 // frames a switch waits for an earlier start, then goes anyway
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+extern uint8_t speed_switch_lines; // scanlines spent by the last switch, LY before and after
+extern uint8_t speed_switch_lines_max;
+extern uint16_t speed_switches; // since boot
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void speed_init(void);
+
+void speed_push_fast(void);
+void speed_pop(void);
+
+void speed_update(void);
+bool speed_is_fast(void);
+
+#endif
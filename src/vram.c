@@ -0,0 +1,238 @@
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+#include <string.h> // memcpy
+
+#include "vram.h"
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define HDMA5_HBLANK 0x80 // write: HBlank DMA, else General DMA
+#define HDMA5_IDLE 0x80 // read: no HBlank DMA running
+
+vram_request_t vram_requests[VRAM_QUEUE_SIZE]; // ring, oldest at vram_head
+uint8_t vram_head;
+uint8_t vram_count;
+
+const uint8_t* stream_src; // HBlank DMA in flight, for vram_wait() with the LCD off
+uint8_t* stream_dst;
+uint8_t stream_blocks; // 0 if none
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  DMA  ------------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static bool is_dma_request(uint8_t* dst, const uint8_t* src, uint16_t size) {
+
+	if (_cpu != CGB_TYPE) return FALSE;
+	if ((((uint16_t)dst | (uint16_t)src | size) & (VRAM_BLOCK_BYTES - 1)) != 0) return FALSE;
+
+	return ((uint16_t)src < 0x8000) || ((uint16_t)src >= 0xA000 && (uint16_t)src < 0xE000); // NOTE: ROM, SRAM, WRAM
+
+}
+
+static void dma_set(uint8_t* dst, const uint8_t* src) {
+
+	HDMA1_REG = (uint8_t)((uint16_t)src >> 8);
+	HDMA2_REG = (uint8_t)(uint16_t)src;
+	HDMA3_REG = (uint8_t)((uint16_t)dst >> 8);
+	HDMA4_REG = (uint8_t)(uint16_t)dst;
+
+}
+
+static void dma_general(uint8_t* dst, const uint8_t* src, uint8_t blocks, uint8_t bank) { // NOTE: LCD off or VBlank only
+
+	VBK_REG = bank;
+	dma_set(dst, src);
+	HDMA5_REG = blocks - 1; // NOTE: CPU halted until done
+	VBK_REG = VBK_TILES;
+
+}
+
+static bool is_stream_running(void) {
+
+	if (stream_blocks == 0) return FALSE;
+	if (HDMA5_REG & HDMA5_IDLE) {
+		stream_blocks = 0;
+		return FALSE;
+	}
+
+	return TRUE;
+
+}
+
+static void stream_start(uint8_t* dst, const uint8_t* src, uint8_t blocks) { // NOTE: LCD on, VBK_TILES
+
+	stream_src = src;
+	stream_dst = dst;
+	stream_blocks = blocks;
+
+	dma_set(dst, src);
+	HDMA5_REG = HDMA5_HBLANK | (blocks - 1);
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ----------------------------------------  QUEUE  ------------------------------------------ *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void advance(vram_request_t* req, uint16_t bytes) { // consumed from the head request
+
+	req->dst += bytes;
+	req->src += bytes;
+	req->size -= bytes;
+
+	if (req->size == 0) {
+		vram_head = (vram_head + 1) % VRAM_QUEUE_SIZE;
+		vram_count--;
+	}
+
+}
+
+static bool update_cpu(vram_request_t* req, bool is_lcd_on) { // TRUE if the frame is used up
+
+	uint16_t bytes = req->size;
+
+	VBK_REG = req->bank;
+	if (is_lcd_on) {
+		if (bytes > VRAM_CPU_CHUNK) bytes = VRAM_CPU_CHUNK;
+		set_data(req->dst, req->src, bytes); // NOTE: waits for VRAM access per byte
+	} else {
+		memcpy(req->dst, req->src, bytes);
+	}
+	VBK_REG = VBK_TILES;
+
+	advance(req, bytes);
+	return is_lcd_on;
+
+}
+
+static bool update_dma(vram_request_t* req, bool is_lcd_on) { // TRUE if the frame is used up
+
+	uint16_t blocks = req->size / VRAM_BLOCK_BYTES;
+	if (blocks > VRAM_HDMA_MAX_BLOCKS) blocks = VRAM_HDMA_MAX_BLOCKS;
+
+	if (!is_lcd_on) {
+		dma_general(req->dst, req->src, (uint8_t)blocks, req->bank);
+		advance(req, blocks * VRAM_BLOCK_BYTES);
+		return FALSE;
+	}
+
+	if (req->bank == VBK_TILES) {
+		stream_start(req->dst, req->src, (uint8_t)blocks);
+		advance(req, blocks * VRAM_BLOCK_BYTES); // NOTE: the registers walk on, the queue is ahead
+		return TRUE;
+	}
+
+	uint8_t ly = LY_REG;
+	if (ly < 144 || ly >= VRAM_DMA_LAST_LINE) return TRUE; // NOTE: missed VBlank, next frame
+
+	uint16_t budget = (uint16_t)(VRAM_DMA_LAST_LINE - ly) * VRAM_DMA_BLOCKS_PER_LINE;
+	if (blocks > budget) blocks = budget;
+
+	dma_general(req->dst, req->src, (uint8_t)blocks, req->bank);
+	advance(req, blocks * VRAM_BLOCK_BYTES);
+	return TRUE;
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void vram_init(void) {
+
+	if (_cpu == CGB_TYPE && !(HDMA5_REG & HDMA5_IDLE)) HDMA5_REG = 0; // NOTE: stops a stream left running
+
+	vram_head = 0;
+	vram_count = 0;
+	stream_blocks = 0;
+
+}
+
+bool vram_queue(uint8_t* dst, const uint8_t* src, uint16_t size, uint8_t bank) {
+
+	if (vram_count == VRAM_QUEUE_SIZE) return FALSE;
+	if (size == 0) return TRUE;
+
+	vram_request_t* req = &vram_requests[(vram_head + vram_count) % VRAM_QUEUE_SIZE];
+	req->dst = dst;
+	req->src = src;
+	req->size = size;
+	req->bank = bank;
+	req->is_dma = is_dma_request(dst, src, size);
+
+	vram_count++;
+	return TRUE;
+
+}
+
+void vram_update(void) { // once per frame, right after vsync(): the VBlank left is the General DMA budget
+
+	if (is_stream_running()) return;
+
+	bool is_lcd_on = (LCDC_REG & LCDCF_ON) != 0;
+
+	while (vram_count != 0) {
+		vram_request_t* req = &vram_requests[vram_head];
+
+		bool is_frame_used = req->is_dma ? update_dma(req, is_lcd_on) : update_cpu(req, is_lcd_on);
+		if (is_frame_used) return;
+	}
+
+}
+
+void vram_wait(void) { // the HBlank DMA in flight is done, the queue behind it is left for vram_update()
+
+	if (!is_stream_running()) return;
+
+	if (LCDC_REG & LCDCF_ON) {
+		while (is_stream_running());
+		return;
+	}
+
+	HDMA5_REG = 0; // NOTE: LCD off, no HBlank comes: stop it and finish by General DMA
+	uint8_t blocks_left = (HDMA5_REG & 0x7F) + 1;
+	uint16_t done = (uint16_t)(stream_blocks - blocks_left) * VRAM_BLOCK_BYTES;
+
+	dma_general(stream_dst + done, stream_src + done, blocks_left, VBK_TILES);
+	stream_blocks = 0;
+
+}
+
+bool vram_is_busy(void) {
+
+	return vram_count != 0 || is_stream_running();
+
+}
+
+void vram_copy_now(uint8_t* dst, const uint8_t* src, uint16_t size, uint8_t bank) { // ahead of the queue, blocking
+
+	vram_wait();
+
+	bool is_lcd_on = (LCDC_REG & LCDCF_ON) != 0;
+
+	if (!is_lcd_on && is_dma_request(dst, src, size)) {
+		while (size != 0) {
+			uint16_t blocks = size / VRAM_BLOCK_BYTES;
+			if (blocks > VRAM_HDMA_MAX_BLOCKS) blocks = VRAM_HDMA_MAX_BLOCKS;
+
+			dma_general(dst, src, (uint8_t)blocks, bank);
+
+			uint16_t bytes = blocks * VRAM_BLOCK_BYTES;
+			dst += bytes;
+			src += bytes;
+			size -= bytes;
+		}
+		return;
+	}
+
+	VBK_REG = bank;
+	if (is_lcd_on) set_data(dst, src, size);
+	else memcpy(dst, src, size);
+	VBK_REG = VBK_TILES;
+
+}
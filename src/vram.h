@@ -0,0 +1,80 @@
+#ifndef VRAM_H
+#define VRAM_H
+
+#include <gb/gb.h>
+#include <gb/cgb.h>
+
+#include <stdbool.h> // bool, true, false
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	VRAM transfer layer: tile and map uploads through the GBC DMA, with a CPU copy fallback.
+
+	Three ways in, picked per request:
+		- General DMA: LCD off, or in VBlank within the lines left (VRAM_DMA_LAST_LINE).
+		  The CPU is halted meanwhile, 16 bytes per 32 dots at either speed.
+		- HBlank DMA: streaming while drawing, 16 bytes per HBlank, VRAM_HDMA_MAX_BLOCKS per
+		  start. The main loop keeps running, halted a few M-cycles per line.
+		- CPU copy: DMG, or a request DMA cant take (below), VRAM_CPU_CHUNK bytes per frame.
+
+	DMA needs src and dst 16-byte aligned, size a multiple of 16, src in ROM or WRAM.
+
+	Usage:
+		- `vram_init()` once.
+		- `vram_copy_now()` blocks until the data is in VRAM, for scene setup with the LCD off.
+		- `vram_queue()` for streaming, e.g. the next tile set while the screen is faded out.
+		  Keep src alive until `vram_is_busy()` is FALSE.
+		- `vram_update()` once per frame, right after `vsync()`: starts the next transfer.
+
+	HBlank DMA writes to the bank VBK_REG selects at each line, so only VBK_TILES requests
+	stream, attribute (VBK_ATTRIBUTES) requests go by General DMA in VBlank.
+	While a stream runs, switch VBK_REG only in VBlank, and `vram_wait()` before DISPLAY_OFF.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -------------------------------------  VRAM MACROS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#ifndef VRAM_QUEUE_SIZE
+#define VRAM_QUEUE_SIZE 8 // requests waiting, vram_queue() fails past that
+#endif
+
+#define VRAM_BLOCK_BYTES 16 // DMA unit, one tile
+#define VRAM_HDMA_MAX_BLOCKS 128 // per HDMA5 start, 2 KB
+
+#define VRAM_DMA_LAST_LINE 152 // General DMA in VBlank ends before this line
+#define VRAM_DMA_BLOCKS_PER_LINE 12 // 14 fit in 456 dots, headroom for the setup
+
+#ifndef VRAM_CPU_CHUNK
+#define VRAM_CPU_CHUNK 256 // bytes per vram_update() on the CPU path, with the LCD on
+#endif
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+typedef struct {
+	uint8_t* dst; // VRAM, 0x8000-0x9FFF
+	const uint8_t* src;
+	uint16_t size; // bytes left
+	uint8_t bank; // VBK_TILES or VBK_ATTRIBUTES
+	bool is_dma;
+} vram_request_t;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  FUNCTIONS  --------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+void vram_init(void);
+
+void vram_copy_now(uint8_t* dst, const uint8_t* src, uint16_t size, uint8_t bank);
+bool vram_queue(uint8_t* dst, const uint8_t* src, uint16_t size, uint8_t bank);
+
+void vram_update(void);
+void vram_wait(void);
+bool vram_is_busy(void);
+
+#endif
@@ -0,0 +1,114 @@
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "fade_math.h"
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Host micro-benchmark of fade_palette_toward(), built once per kernel: make bench
+
+	ns per palette-step on the host CPU, SCALAR and SWAR only. The ASM kernel is SM83 code and
+	doesnt build for the host; its cost is counted in M-cycles instead, see fade_kernel.s
+	(<= 664 per palette).
+
+	On the host SWAR comes out slower than SCALAR (~45 vs ~21-27 ns here). The host CPU predicts
+	the SCALAR compares, or turns them into cmov, and runs the 3 channels in parallel, while SWAR
+	is two passes of one long dependent chain of 16-bit ops each. That says nothing about the
+	SM83, which has no branch prediction or 16-bit ALU ops to speak of: only an on-device build
+	(FADE_PROFILE scanline counters) ranks the C kernels there.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#if FADE_KERNEL == FADE_KERNEL_SCALAR
+#define FADE_KERNEL_NAME "SCALAR"
+#elif FADE_KERNEL == FADE_KERNEL_SWAR
+#define FADE_KERNEL_NAME "SWAR"
+#endif
+
+#define BENCH_PALETTES 16 // all hardware palettes, one frame of a full-screen fade
+#define BENCH_ROUNDS 200000
+
+volatile uint16_t bench_sink; // keeps the results alive
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static double now_ns(void) {
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+
+}
+
+static double bench_fade(const uint16_t* from, const uint16_t* target) { // full 24-frame fades, back and forth, ns per palette-step
+
+	uint16_t palettes[BENCH_PALETTES * PALETTE_SIZE];
+	unsigned long steps = 0;
+
+	for (int i = 0; i < BENCH_PALETTES * PALETTE_SIZE; i++) palettes[i] = from[i];
+
+	double start = now_ns();
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		fade_pace_t pace;
+		fade_pace_init(&pace, 24);
+
+		const uint16_t* to = (round & 1) ? from : target;
+
+		for (int frame = 0; frame < 24; frame++) {
+			uint8_t step = fade_pace_step(&pace);
+
+			for (int p = 0; p < BENCH_PALETTES; p++) {
+				fade_palette_toward(&palettes[p * PALETTE_SIZE], &to[p * PALETTE_SIZE], step);
+			}
+			steps += BENCH_PALETTES;
+		}
+	}
+
+	double elapsed = now_ns() - start;
+
+	bench_sink = palettes[0];
+
+	return elapsed / (double)steps;
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  MAIN  ------------------------------------------ *//
+//* ------------------------------------------------------------------------------------------- *//
+
+int main(void) {
+
+	uint16_t colors[BENCH_PALETTES * PALETTE_SIZE];
+	uint16_t black[BENCH_PALETTES * PALETTE_SIZE];
+	uint16_t white[BENCH_PALETTES * PALETTE_SIZE];
+
+	uint32_t seed = 0x2545F491;
+
+	for (int i = 0; i < BENCH_PALETTES * PALETTE_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		colors[i] = (uint16_t)((seed >> 8) & 0x7FFF);
+		black[i] = 0x0000;
+		white[i] = 0x7FFF;
+	}
+
+	printf("fade_bench, kernel %s\n", FADE_KERNEL_NAME);
+	printf("  to/from black : %6.2f ns/palette-step\n", bench_fade(colors, black));
+	printf("  to/from white : %6.2f ns/palette-step\n", bench_fade(colors, white));
+
+	return 0;
+
+}
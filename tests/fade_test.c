@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fade_math.h"
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	Host tests of src/fade_math.c, built once per kernel: make test
+
+	- clamping: every RGB555 color, every step 0-31, against gray, black/white, its complement,
+	  itself and a fixed set of pseudo-random targets, checked per channel against a plain reference.
+	- convergence: every duration 1-255, black/white to palettes and back, exact on the last frame,
+	  never before the path allows it, never overshooting.
+	- transforms: luma of every RGB555 color within rounding of the float weights, ramp mapping.
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#if FADE_KERNEL == FADE_KERNEL_SCALAR
+#define FADE_KERNEL_NAME "SCALAR"
+#elif FADE_KERNEL == FADE_KERNEL_SWAR
+#define FADE_KERNEL_NAME "SWAR"
+#endif
+
+#define RANDOM_TARGETS 64
+#define CONVERGENCE_PALETTES 64
+
+#define RGB555(r, g, b) ((uint16_t)((r) | ((g) << 5) | ((b) << 10)))
+#define CHANNEL(color, shift) (((color) >> (shift)) & 0x1F)
+
+uint32_t rng_state = 0x2545F491;
+
+unsigned long checks;
+unsigned long failures;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ---------------------------------------  ROUTINES  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static uint16_t random_color(void) { // xorshift32, same sequence every run
+
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+
+	return (uint16_t)(rng_state & 0x7FFF);
+
+}
+
+static int reference_channel(int channel, int target, int step) { // the spec: move by step, never past target
+
+	if (channel < target) return (channel + step < target) ? channel + step : target;
+	return (channel - step > target) ? channel - step : target;
+
+}
+
+static uint16_t reference_color(uint16_t color, uint16_t target, int step) {
+
+	return RGB555(
+		reference_channel(CHANNEL(color, 0), CHANNEL(target, 0), step),
+		reference_channel(CHANNEL(color, 5), CHANNEL(target, 5), step),
+		reference_channel(CHANNEL(color, 10), CHANNEL(target, 10), step)
+	);
+
+}
+
+static void fail(const char* test, uint16_t color, uint16_t target, int step, uint16_t got, uint16_t expected) {
+
+	if (failures++ < 10) printf("  FAIL %s: color %04X target %04X step %d -> %04X, expected %04X\n", test, color, target, step, got, expected);
+
+}
+
+static void check_colors(uint16_t color, const uint16_t* targets, int step) { // one palette: 4 targets, same color
+
+	uint16_t palette[PALETTE_SIZE] = { color, color, color, color };
+	bool expected_converged = true;
+
+	bool converged = fade_palette_toward(palette, targets, (uint8_t)step);
+
+	for (int i = 0; i < PALETTE_SIZE; i++) {
+		uint16_t expected = reference_color(color, targets[i], step);
+
+		checks++;
+		if (palette[i] != expected) fail("clamp", color, targets[i], step, palette[i], expected);
+		if (expected != targets[i]) expected_converged = false;
+	}
+
+	checks++;
+	if (converged != expected_converged) fail("converged-flag", color, targets[0], step, converged, expected_converged);
+
+}
+
+static void test_clamping(void) {
+
+	uint16_t random_targets[RANDOM_TARGETS];
+	for (int i = 0; i < RANDOM_TARGETS; i++) random_targets[i] = random_color();
+
+	for (uint32_t color = 0; color < 0x8000; color++) {
+		for (int step = 0; step <= FADE_DISTANCE; step++) {
+			uint16_t targets[PALETTE_SIZE];
+
+			for (int k = 0; k < 32; k += PALETTE_SIZE) { // grays
+				for (int i = 0; i < PALETTE_SIZE; i++) targets[i] = RGB555(k + i, k + i, k + i);
+				check_colors((uint16_t)color, targets, step);
+			}
+
+			targets[0] = RGB555(0, 0, 0);
+			targets[1] = RGB555(31, 31, 31);
+			targets[2] = (uint16_t)(~color & 0x7FFF);
+			targets[3] = (uint16_t)color;
+			check_colors((uint16_t)color, targets, step);
+
+			for (int k = 0; k < RANDOM_TARGETS; k += PALETTE_SIZE) {
+				check_colors((uint16_t)color, &random_targets[k], step);
+			}
+		}
+	}
+
+}
+
+static int fade_between(uint16_t* palette, const uint16_t* target, uint8_t frames) { // full fade, returns frames until converged
+
+	fade_pace_t pace;
+	fade_pace_init(&pace, frames);
+
+	uint16_t previous[PALETTE_SIZE];
+	int converged_at = -1;
+
+	for (int frame = 1; frame <= frames; frame++) {
+		for (int i = 0; i < PALETTE_SIZE; i++) previous[i] = palette[i];
+
+		bool converged = fade_palette_toward(palette, target, fade_pace_step(&pace));
+
+		for (int i = 0; i < PALETTE_SIZE; i++) { // every channel only gets closer
+			for (int shift = 0; shift <= 10; shift += 5) {
+				int before = CHANNEL(previous[i], shift) - CHANNEL(target[i], shift);
+				int after = CHANNEL(palette[i], shift) - CHANNEL(target[i], shift);
+
+				checks++;
+				if ((before >= 0 && (after < 0 || after > before)) || (before < 0 && (after > 0 || after < before))) {
+					fail("overshoot", previous[i], target[i], frame, palette[i], target[i]);
+				}
+			}
+		}
+
+		if (converged && converged_at < 0) converged_at = frame;
+	}
+
+	return converged_at;
+
+}
+
+static void test_convergence(void) {
+
+	static const uint16_t black[PALETTE_SIZE] = { 0, 0, 0, 0 };
+	static const uint16_t white[PALETTE_SIZE] = { 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF };
+
+	uint16_t originals[CONVERGENCE_PALETTES][PALETTE_SIZE];
+
+	for (int p = 0; p < CONVERGENCE_PALETTES; p++) {
+		for (int i = 0; i < PALETTE_SIZE; i++) originals[p][i] = random_color();
+	}
+	originals[0][0] = RGB555(31, 0, 0); // full distance in every channel, for both directions
+	originals[0][1] = RGB555(0, 31, 0);
+	originals[0][2] = RGB555(0, 0, 31);
+	originals[0][3] = RGB555(31, 31, 31);
+
+	for (int frames = 1; frames <= 255; frames++) {
+		for (int p = 0; p < CONVERGENCE_PALETTES; p++) {
+			const uint16_t* ends[2] = { black, white };
+
+			for (int e = 0; e < 2; e++) {
+				uint16_t palette[PALETTE_SIZE];
+
+				for (int i = 0; i < PALETTE_SIZE; i++) palette[i] = ends[e][i]; // in: black/white to original
+				int in = fade_between(palette, originals[p], (uint8_t)frames);
+
+				checks++;
+				if (in < 0) fail("converge-in", ends[e][0], originals[p][0], frames, palette[0], originals[p][0]);
+
+				int out = fade_between(palette, ends[e], (uint8_t)frames); // out: and back
+
+				checks++;
+				if (out < 0) fail("converge-out", originals[p][0], ends[e][0], frames, palette[0], ends[e][0]);
+
+				if (p == 0) { // full distance needs every frame, no earlier
+					checks++;
+					if (in != frames || out != frames) fail("converge-full", ends[e][0], originals[p][0], frames, (uint16_t)in, (uint16_t)frames);
+				}
+			}
+		}
+	}
+
+}
+
+static void test_transforms(void) { // luma tables against the float weights, ramps only map through luma
+
+	for (uint32_t color = 0; color <= 0x7FFF; color++) {
+		int r = color & 0x1F, g = (color >> 5) & 0x1F, b = (color >> 10) & 0x1F;
+		double exact = 0.299 * r + 0.587 * g + 0.114 * b;
+		int luma = fade_color_luma((uint16_t)color);
+
+		checks++;
+		if (luma < 0 || luma > 31 || luma < exact - 1.5 || luma > exact + 1.5) fail("luma", (uint16_t)color, 0, 0, (uint16_t)luma, (uint16_t)(exact + 0.5));
+	}
+
+	checks += 2;
+	if (fade_color_luma(RGB555(31, 31, 31)) != 31) fail("luma-white", RGB555(31, 31, 31), 0, 0, fade_color_luma(RGB555(31, 31, 31)), 31);
+	if (fade_color_luma(0) != 0) fail("luma-black", 0, 0, 0, fade_color_luma(0), 0);
+
+	for (int i = 0; i < 4096; i++) {
+		uint16_t palette[PALETTE_SIZE];
+		uint16_t grey[PALETTE_SIZE];
+
+		for (int c = 0; c < PALETTE_SIZE; c++) palette[c] = random_color();
+		fade_palette_map(grey, palette, fade_ramp_grey);
+
+		for (int c = 0; c < PALETTE_SIZE; c++) {
+			checks++;
+			if (grey[c] != fade_ramp_grey[fade_color_luma(palette[c])]) fail("map-grey", palette[c], 0, 0, grey[c], fade_ramp_grey[fade_color_luma(palette[c])]);
+		}
+	}
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  MAIN  ------------------------------------------ *//
+//* ------------------------------------------------------------------------------------------- *//
+
+int main(void) {
+
+	printf("fade_test, kernel %s\n", FADE_KERNEL_NAME);
+
+	test_clamping();
+	printf("  clamping    : %lu checks, %lu failures\n", checks, failures);
+
+	unsigned long clamping_checks = checks;
+	test_convergence();
+	printf("  convergence : %lu checks, %lu failures\n", checks - clamping_checks, failures);
+
+	unsigned long convergence_checks = checks;
+	test_transforms();
+	printf("  transforms  : %lu checks, %lu failures\n", checks - convergence_checks, failures);
+
+	return failures ? 1 : 0;
+
+}
@@ -0,0 +1,410 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "fade_math.h"
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  NOTES  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+/*
+	palc - host palette compiler, run by the Makefile before the ROM build.
+
+		palc -o build/gen/palettes assets/palettes.pal [more.pal | some.gpl ...]
+
+	Reads palette definitions and writes <out>.h / <out>.c: const palettes, named targets, and a
+	fade ladder per palette and baked target, both ways. A ladder holds all FADE_DISTANCE + 1
+	levels, level k = the palette stepped k toward the target, computed with the same
+	fade_palette_toward() as the ROM. Steps add up, so a DDA fade of any duration lands on
+	ladder levels, and the ROM only copies level k (see fade_ladder_t in fade.h).
+
+	.pal, line based, # comments:
+		palette <name> <r,g,b> <r,g,b> <r,g,b> <r,g,b>		4 colors, channels 0-31
+		target <name> <r,g,b>								named fade target, every color the same
+		bake <target> [<target> ...]						targets to bake ladders for, builtin: black white
+
+	.gpl (GIMP palette): every 4 colors are one palette, <Name>_0, <Name>_1, ..., channels 0-255
+	rounded down to 5 bits. No bake line, uses the bake targets of the .pal files (or black white).
+*/
+
+//* ------------------------------------------------------------------------------------------- *//
+//* --------------------------------------  DEFINITIONS  -------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+#define MAX_PALETTES 128
+#define MAX_TARGETS 16
+#define MAX_NAME 32
+#define MAX_LINE 512
+
+#define LADDER_LEVELS (FADE_DISTANCE + 1)
+
+#define RGB555(r, g, b) ((uint16_t)((r) | ((g) << 5) | ((b) << 10)))
+#define CHANNEL(color, shift) (((color) >> (shift)) & 0x1F)
+
+typedef struct {
+	char name[MAX_NAME];
+	uint16_t colors[PALETTE_SIZE];
+} palette_t;
+
+typedef struct {
+	char name[MAX_NAME];
+	char symbol[MAX_NAME + 16]; // C name of its 4-color palette
+	uint16_t color;
+	bool is_builtin;
+	bool is_baked;
+} target_t;
+
+palette_t palettes[MAX_PALETTES];
+int palette_count;
+
+target_t targets[MAX_TARGETS] = {
+	{ "black", "palette_all_black", RGB555(0, 0, 0), true, false }, // fade.c
+	{ "white", "palette_all_white", RGB555(31, 31, 31), true, false }
+};
+int target_count = 2;
+
+bool has_bake_line;
+
+const char* current_file;
+int current_line;
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ----------------------------------------  PARSING  ---------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void die(const char* message, const char* detail) {
+
+	if (current_file) fprintf(stderr, "palc: %s:%d: %s %s\n", current_file, current_line, message, detail ? detail : "");
+	else fprintf(stderr, "palc: %s %s\n", message, detail ? detail : "");
+	exit(1);
+
+}
+
+static void check_name(const char* name) { // becomes part of a C identifier
+
+	if (strlen(name) == 0 || strlen(name) >= MAX_NAME) die("bad name length:", name);
+
+	for (const char* c = name; *c; c++) {
+		if (!isalnum((unsigned char)*c) && *c != '_') die("name must be [A-Za-z0-9_]:", name);
+	}
+
+	for (int i = 0; i < palette_count; i++) {
+		if (strcmp(palettes[i].name, name) == 0) die("duplicate palette:", name);
+	}
+
+}
+
+static uint16_t parse_color(const char* token) { // r,g,b with channels 0-31
+
+	int r, g, b;
+	char tail;
+
+	if (token == NULL) die("missing color", NULL);
+	if (sscanf(token, "%d,%d,%d%c", &r, &g, &b, &tail) != 3) die("bad color, want r,g,b:", token);
+	if (r < 0 || r > 31 || g < 0 || g > 31 || b < 0 || b > 31) die("channel out of 0-31:", token);
+
+	return RGB555(r, g, b);
+
+}
+
+static target_t* find_target(const char* name) {
+
+	for (int i = 0; i < target_count; i++) {
+		if (strcmp(targets[i].name, name) == 0) return &targets[i];
+	}
+
+	return NULL;
+
+}
+
+static palette_t* add_palette(const char* name) {
+
+	check_name(name);
+	if (palette_count == MAX_PALETTES) die("too many palettes, max", "128");
+
+	palette_t* palette = &palettes[palette_count++];
+	strcpy(palette->name, name);
+
+	return palette;
+
+}
+
+static void parse_pal(FILE* file) {
+
+	char line[MAX_LINE];
+
+	while (fgets(line, sizeof(line), file)) {
+		current_line++;
+
+		char* comment = strchr(line, '#');
+		if (comment) *comment = '\0';
+
+		char* keyword = strtok(line, " \t\r\n");
+		if (keyword == NULL) continue;
+
+		if (strcmp(keyword, "palette") == 0) {
+			const char* name = strtok(NULL, " \t\r\n");
+			if (name == NULL) die("palette without name", NULL);
+
+			palette_t* palette = add_palette(name);
+			for (int i = 0; i < PALETTE_SIZE; i++) palette->colors[i] = parse_color(strtok(NULL, " \t\r\n"));
+
+			if (strtok(NULL, " \t\r\n")) die("more than 4 colors in palette", name);
+		}
+		else if (strcmp(keyword, "target") == 0) {
+			const char* name = strtok(NULL, " \t\r\n");
+			if (name == NULL) die("target without name", NULL);
+			if (find_target(name)) die("duplicate target:", name);
+			if (target_count == MAX_TARGETS) die("too many targets, max", "16");
+
+			check_name(name);
+
+			target_t* target = &targets[target_count++];
+			strcpy(target->name, name);
+			snprintf(target->symbol, sizeof(target->symbol), "palette_target_%s", name);
+			target->color = parse_color(strtok(NULL, " \t\r\n"));
+			target->is_builtin = false;
+			target->is_baked = false;
+		}
+		else if (strcmp(keyword, "bake") == 0) {
+			const char* name;
+
+			while ((name = strtok(NULL, " \t\r\n"))) {
+				target_t* target = find_target(name);
+				if (target == NULL) die("bake of unknown target (declare it first):", name);
+				target->is_baked = true;
+			}
+			has_bake_line = true;
+		}
+		else {
+			die("unknown keyword:", keyword);
+		}
+	}
+
+}
+
+static void parse_gpl(FILE* file) {
+
+	char line[MAX_LINE];
+	char name[MAX_NAME] = "gpl";
+	palette_t* palette = NULL;
+	int index = 0;
+	int color = 0;
+
+	if (!fgets(line, sizeof(line), file) || strncmp(line, "GIMP Palette", 12) != 0) die("not a GIMP palette", NULL);
+	current_line++;
+
+	while (fgets(line, sizeof(line), file)) {
+		current_line++;
+
+		if (strncmp(line, "Name:", 5) == 0) {
+			if (sscanf(line + 5, " %30[A-Za-z0-9_]", name) != 1) die("bad Name:", line + 5);
+			continue;
+		}
+		if (strncmp(line, "Columns:", 8) == 0 || line[0] == '#') continue;
+
+		int r, g, b;
+		if (sscanf(line, "%d %d %d", &r, &g, &b) != 3) continue;
+		if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255) die("channel out of 0-255", NULL);
+
+		if (color == 0) {
+			char palette_name[MAX_NAME + 8];
+			snprintf(palette_name, sizeof(palette_name), "%s_%d", name, index++);
+			palette = add_palette(palette_name);
+		}
+
+		palette->colors[color] = RGB555(r >> 3, g >> 3, b >> 3);
+		color = (color + 1) % PALETTE_SIZE;
+	}
+
+	if (color != 0) die("color count not a multiple of 4", NULL);
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* ----------------------------------------  OUTPUT  ----------------------------------------- *//
+//* ------------------------------------------------------------------------------------------- *//
+
+static void write_rgb(FILE* out, uint16_t color, const char* separator) {
+
+	fprintf(out, "\tRGB(%d, %d, %d)%s\n", CHANNEL(color, 0), CHANNEL(color, 5), CHANNEL(color, 10), separator);
+
+}
+
+static uint8_t write_ladder(FILE* out, const char* symbol, const uint16_t* from, const uint16_t* to) { // returns the level where it converged
+
+	uint8_t end = FADE_DISTANCE;
+
+	fprintf(out, "const palette_color_t %s[%d * PALETTE_SIZE] = {\n", symbol, LADDER_LEVELS);
+
+	for (int level = 0; level < LADDER_LEVELS; level++) {
+		uint16_t colors[PALETTE_SIZE];
+		memcpy(colors, from, sizeof(colors));
+
+		if (fade_palette_toward(colors, to, (uint8_t)level) && level < end) end = (uint8_t)level;
+
+		fprintf(out, "\t0x%04X, 0x%04X, 0x%04X, 0x%04X%s // %d\n", colors[0], colors[1], colors[2], colors[3], level < LADDER_LEVELS - 1 ? "," : "", level);
+	}
+
+	fprintf(out, "};\n\n");
+
+	return end;
+
+}
+
+static void write_header(FILE* out, const char* guard) {
+
+	fprintf(out, "// generated by tools/palc.c, do not edit\n\n");
+	fprintf(out, "#ifndef %s\n#define %s\n\n", guard, guard);
+	fprintf(out, "#include \"fade.h\"\n\n");
+
+	for (int i = 0; i < palette_count; i++) {
+		fprintf(out, "extern const palette_color_t palette_%s[];\n", palettes[i].name);
+	}
+	fprintf(out, "\n");
+
+	for (int i = 0; i < target_count; i++) {
+		if (targets[i].is_builtin) continue;
+		fprintf(out, "extern const palette_color_t %s[];\n", targets[i].symbol);
+		fprintf(out, "extern const palette_color_t* const palette_set_%s[PALETTE_SLOTS];\n", targets[i].name);
+	}
+
+	int ladders = 0;
+	for (int i = 0; i < target_count; i++) {
+		if (targets[i].is_baked) ladders += palette_count * 2;
+	}
+
+	fprintf(out, "\n#define PALETTE_LADDERS_COUNT %d\n\n", ladders);
+	fprintf(out, "extern const fade_ladder_t palette_ladders[%d];\n\n", ladders ? ladders : 1);
+	fprintf(out, "#endif\n");
+
+}
+
+static void write_source(FILE* out, const char* header) {
+
+	fprintf(out, "// generated by tools/palc.c, do not edit\n\n");
+	fprintf(out, "#include <gb/gb.h>\n#include <gb/cgb.h>\n\n");
+	fprintf(out, "#include \"%s\"\n\n", header);
+
+	for (int i = 0; i < palette_count; i++) {
+		fprintf(out, "const palette_color_t palette_%s[] = {\n", palettes[i].name);
+		for (int c = 0; c < PALETTE_SIZE; c++) write_rgb(out, palettes[i].colors[c], c < PALETTE_SIZE - 1 ? "," : "");
+		fprintf(out, "};\n\n");
+	}
+
+	for (int i = 0; i < target_count; i++) {
+		if (targets[i].is_builtin) continue;
+
+		fprintf(out, "const palette_color_t %s[] = {\n", targets[i].symbol);
+		for (int c = 0; c < PALETTE_SIZE; c++) write_rgb(out, targets[i].color, c < PALETTE_SIZE - 1 ? "," : "");
+		fprintf(out, "};\n\n");
+		fprintf(out, "const palette_color_t* const palette_set_%s[PALETTE_SLOTS] = PALETTE_SET_OF(%s);\n\n", targets[i].name, targets[i].symbol);
+	}
+
+	uint8_t ends[MAX_TARGETS][MAX_PALETTES][2];
+
+	for (int t = 0; t < target_count; t++) {
+		if (!targets[t].is_baked) continue;
+
+		uint16_t target[PALETTE_SIZE];
+		for (int c = 0; c < PALETTE_SIZE; c++) target[c] = targets[t].color;
+
+		for (int i = 0; i < palette_count; i++) {
+			char symbol[MAX_NAME * 2 + 32];
+
+			snprintf(symbol, sizeof(symbol), "ladder_%.31s_to_%.31s", palettes[i].name, targets[t].name);
+			ends[t][i][0] = write_ladder(out, symbol, palettes[i].colors, target);
+
+			snprintf(symbol, sizeof(symbol), "ladder_%.31s_from_%.31s", palettes[i].name, targets[t].name);
+			ends[t][i][1] = write_ladder(out, symbol, target, palettes[i].colors);
+		}
+	}
+
+	fprintf(out, "const fade_ladder_t palette_ladders[] = { // from, to, levels, end\n");
+
+	int written = 0;
+
+	for (int t = 0; t < target_count; t++) {
+		if (!targets[t].is_baked) continue;
+
+		for (int i = 0; i < palette_count; i++) {
+			fprintf(out, "\t{ palette_%s, %s, ladder_%s_to_%s, %d },\n", palettes[i].name, targets[t].symbol, palettes[i].name, targets[t].name, ends[t][i][0]);
+			fprintf(out, "\t{ %s, palette_%s, ladder_%s_from_%s, %d },\n", targets[t].symbol, palettes[i].name, palettes[i].name, targets[t].name, ends[t][i][1]);
+			written += 2;
+		}
+	}
+
+	if (written == 0) fprintf(out, "\t{ NULL, NULL, NULL, 0 }\n");
+	fprintf(out, "};\n");
+
+}
+
+//* ------------------------------------------------------------------------------------------- *//
+//* -----------------------------------------  MAIN  ------------------------------------------ *//
+//* ------------------------------------------------------------------------------------------- *//
+
+int main(int argc, char** argv) {
+
+	const char* out_base = NULL;
+	int first_input = 1;
+
+	if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+		out_base = argv[2];
+		first_input = 3;
+	}
+	if (out_base == NULL || first_input >= argc) {
+		fprintf(stderr, "usage: palc -o <out-base> <input.pal|input.gpl> ...\n");
+		return 1;
+	}
+
+	for (int i = first_input; i < argc; i++) {
+		FILE* file = fopen(argv[i], "r");
+		if (file == NULL) die("cant open", argv[i]);
+
+		current_file = argv[i];
+		current_line = 0;
+
+		size_t length = strlen(argv[i]);
+		if (length > 4 && strcmp(argv[i] + length - 4, ".gpl") == 0) parse_gpl(file);
+		else parse_pal(file);
+
+		fclose(file);
+	}
+
+	current_file = NULL;
+
+	if (!has_bake_line) { // NOTE: default, ladders to and from black and white
+		targets[0].is_baked = true;
+		targets[1].is_baked = true;
+	}
+
+	char path[512];
+	const char* header_name = strrchr(out_base, '/') ? strrchr(out_base, '/') + 1 : out_base;
+	char header[256];
+	char guard[256];
+
+	snprintf(header, sizeof(header), "%s.h", header_name);
+
+	int g = 0;
+	for (const char* c = header_name; *c && g < (int)sizeof(guard) - 3; c++) guard[g++] = isalnum((unsigned char)*c) ? (char)toupper((unsigned char)*c) : '_';
+	strcpy(&guard[g], "_H");
+
+	snprintf(path, sizeof(path), "%s.h", out_base);
+	FILE* out = fopen(path, "w");
+	if (out == NULL) die("cant write", path);
+	write_header(out, guard);
+	fclose(out);
+
+	snprintf(path, sizeof(path), "%s.c", out_base);
+	out = fopen(path, "w");
+	if (out == NULL) die("cant write", path);
+	write_source(out, header);
+	fclose(out);
+
+	return 0;
+
+}